@@ -32,18 +32,14 @@ function does it all.
 
 #include <iostream>
 #include <array>
+#include <vector>
+#include <random>
 
-namespace ecs {
-
-constexpr int pow(int base, int exp) noexcept // C++14
-{
-    auto result = 1;
-    for (int i = 0; i < exp; ++i) result *= base;
-
-    return result;
-}
-
-}
+#include "Chronometer.h"
+#include "pow.h"
+#include "point.h"
+#include "pointbuffer.h"
+#include "pointexpr.h"
 
 void constexprFuncTest() {
     constexpr auto numConds = 5;
@@ -57,43 +53,79 @@ void constexprFuncTest() {
     std::cout << ecs::pow(x, y) << std::endl;
 }
 
+void powVariantsTest() {
+    static_assert(ecs::powBySquaring(3, 5) == ecs::pow(3, 5), "same result as the loop version");
+    static_assert(ecs::checkedPow(2, 30) == (1 << 30), "fits in int");
+    // constexpr auto tooBig = ecs::checkedPow(2, 31); // Does not compile since checkedPow throws during constant evaluation
+
+    constexpr auto& powersOf3 = ecs::pow_table<3, 19>; // 3^19 is the largest power of 3 that fits in int
+    static_assert(powersOf3[4] == 81, "table is generated during compilation");
+    // constexpr auto& tooLarge = ecs::pow_table<3, 20>; // Does not compile, 3^20 overflows int
+
+    int exp = 7;
+    std::cout << "3^7 from table is " << powersOf3.lookup(exp) << std::endl;
+
+    try {
+        std::cout << ecs::checkedPow(10, exp + 3) << std::endl;
+    } catch(const std::overflow_error& e) {
+        std::cout << e.what() << std::endl;
+    }
+}
+
+void powSpeedTest() {
+    constexpr std::size_t count = 1 << 22;
+    std::vector<int> bases(count);
+    std::vector<int> exps(count);
+    std::vector<int> results(count);
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> baseDist(-3, 3);
+    std::uniform_int_distribution<int> expDist(0, 19); // 3^19 still fits in int
+    for(std::size_t i = 0; i < count; ++i) {
+        bases[i] = baseDist(gen);
+        exps[i] = expDist(gen);
+    }
+
+    long long checksum = 0;
+    utils::Chronometer ch;
+
+    ch.Start();
+    for(std::size_t i = 0; i < count; ++i) results[i] = ecs::pow(bases[i], exps[i]);
+    ch.Stop();
+    for(auto r : results) checksum += r;
+    ch.Report("Loop pow - ");
+
+    ch.Start();
+    for(std::size_t i = 0; i < count; ++i) results[i] = ecs::powBySquaring(bases[i], exps[i]);
+    ch.Stop();
+    for(auto r : results) checksum -= r;
+    ch.Report("Pow by squaring - ");
+
+    ch.Start();
+    ecs::pow(bases.data(), exps.data(), results.data(), count);
+    ch.Stop();
+    for(auto r : results) checksum += r;
+    ch.Report("Batch pow - ");
+
+    constexpr auto& powersOf3 = ecs::pow_table<3, 19>;
+    ch.Start();
+    for(std::size_t i = 0; i < count; ++i) results[i] = powersOf3[exps[i]];
+    ch.Stop();
+    for(std::size_t i = 0; i < count; ++i) checksum -= ecs::pow(3, exps[i]) - results[i];
+    ch.Report("Pow table (base 3) - ");
+
+    std::cout << "Checksum (expected to be sum of loop pow results) " << checksum << std::endl;
+}
+
 /*
 
 constexpr functions are limited to taking and returning literal types, which essen‐
 tially means types that can have values determined during compilation. In C++11, all
 built-in types except void qualify(in C++14 this restriction is lifted), but user-defined types may be literal, too, because
-constructors and other member functions may be constexpr:
+constructors and other member functions may be constexpr.
 
+Point, midpoint and reflection are in point.h, so that PointBuffer (pointbuffer.h) can share them.
 */
-class Point {
-public:
-    constexpr Point(double xVal = 0, double yVal = 0) noexcept
-    : x(xVal), y(yVal)
-    {}
-    constexpr double xValue() const noexcept { return x; }
-    constexpr double yValue() const noexcept { return y; }
-    constexpr void setX(double newX) noexcept { x = newX; }
-    constexpr void setY(double newY) noexcept { y = newY; }
-
-private:
-    double x, y;
-};
-
-constexpr
-Point midpoint(const Point& p1, const Point& p2) noexcept
-{
-    return { (p1.xValue() + p2.xValue()) / 2, // call constexpr member funcs
-                (p1.yValue() + p2.yValue()) / 2 };
-}
-
-// return reflection of p with respect to the origin (C++14)
-constexpr Point reflection(const Point& p) noexcept
-{
-    Point result; // create non-const Point
-    result.setX(-p.xValue()); // set its x and y values
-    result.setY(-p.yValue());
-    return result; // return copy of it
-}
 
 void constexprClassTest() {
     constexpr Point p1(9.4, 27.7); // fine, "runs" constexpr ctor during compilation
@@ -106,9 +138,150 @@ void constexprClassTest() {
     std::cout << "Result size is " << results.size() << std::endl;
 }
 
+void reportThroughput(utils::Chronometer& ch, const std::string& pre, std::size_t points) {
+    const auto seconds = ch.Elapsed().count() * 1e-9;
+    ch.Report(pre);
+    std::cout << "    " << points / seconds / 1e6 << " million points per second" << std::endl;
+}
+
+void pointBufferSpeedTest() {
+    constexpr std::size_t count = 1 << 14; // small enough to stay in cache, so the kernels are measured rather than memory
+    constexpr int rounds = 5000;
+
+    std::vector<Point> aos1, aos2, aosOut(count);
+    PointBuffer soa1, soa2, soaOut(count);
+    aos1.reserve(count); aos2.reserve(count);
+    soa1.reserve(count); soa2.reserve(count);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-100., 100.);
+    for(std::size_t i = 0; i < count; ++i) {
+        const Point p1(dist(gen), dist(gen));
+        const Point p2(dist(gen), dist(gen));
+        aos1.push_back(p1); aos2.push_back(p2);
+        soa1.push_back(p1); soa2.push_back(p2);
+    }
+
+    utils::Chronometer ch;
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        for(std::size_t i = 0; i < count; ++i) aosOut[i] = midpoint(aos1[i], aos2[i]);
+    }
+    ch.Stop();
+    reportThroughput(ch, "AoS midpoint - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) midpoint(soa1, soa2, soaOut);
+    ch.Stop();
+    reportThroughput(ch, "PointBuffer midpoint - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        for(std::size_t i = 0; i < count; ++i) aosOut[i] = reflection(aos1[i]);
+    }
+    ch.Stop();
+    reportThroughput(ch, "AoS reflection - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) reflection(soa1, soaOut);
+    ch.Stop();
+    reportThroughput(ch, "PointBuffer reflection - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        for(auto& p : aos1) p = translate(p, 1., -1.);
+    }
+    ch.Stop();
+    reportThroughput(ch, "AoS translate - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) translate(soa1, 1., -1.);
+    ch.Stop();
+    reportThroughput(ch, "PointBuffer translate - ", count * rounds);
+
+    // both layouts must agree, this also keeps the loops above from being optimized away
+    const auto last = count - 1;
+    std::cout << "Last point AoS " << aos1[last].xValue() << "," << aos1[last].yValue()
+              << " PointBuffer " << soa1[last].xValue() << "," << soa1[last].yValue() << std::endl;
+    std::cout << "Last reflection AoS " << aosOut[last].xValue() << " PointBuffer " << soaOut[last].xValue() << std::endl;
+}
+
+void expressionTemplateTest() {
+    constexpr Point p1(9.4, 27.7);
+    constexpr Point p2(28.8, 5.3);
+    constexpr Point p3(1., 1.);
+    constexpr Point r = (p1 + p2) * 0.5 - p3; // whole expression is evaluated during compilation, in one pass
+    static_assert(r.xValue() == midpoint(p1, p2).xValue() - p3.xValue(), "same as the midpoint chain");
+    std::cout << "(p1 + p2) * 0.5 - p3 is " << r.xValue() << "," << r.yValue() << std::endl;
+
+    PointBuffer b1, b2;
+    b1.push_back(p1); b1.push_back(p2);
+    b2.push_back(p2); b2.push_back(p1);
+    PointBuffer mids = (b1 + b2) * 0.5 - p3; // p3 is used for every element
+    std::cout << "Buffer results are " << mids[0].xValue() << "," << mids[1].xValue() << std::endl;
+}
+
+void expressionTemplateSpeedTest() {
+    constexpr std::size_t count = 1 << 14;
+    constexpr int rounds = 5000;
+
+    std::vector<Point> aos1, aos2, aos3, aosOut(count);
+    PointBuffer soa1, soa2, soa3, soaTmp(count), soaOut(count);
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(-100., 100.);
+    for(std::size_t i = 0; i < count; ++i) {
+        const Point p1(dist(gen), dist(gen));
+        const Point p2(dist(gen), dist(gen));
+        const Point p3(dist(gen), dist(gen));
+        aos1.push_back(p1); aos2.push_back(p2); aos3.push_back(p3);
+        soa1.push_back(p1); soa2.push_back(p2); soa3.push_back(p3);
+    }
+
+    utils::Chronometer ch;
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        for(std::size_t i = 0; i < count; ++i) {
+            const auto mid = midpoint(aos1[i], aos2[i]);
+            aosOut[i] = translate(mid, -aos3[i].xValue(), -aos3[i].yValue());
+        }
+    }
+    ch.Stop();
+    reportThroughput(ch, "AoS midpoint chain - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        midpoint(soa1, soa2, soaTmp); // materialises the midpoints
+        reflection(soa3, soaOut);
+        for(std::size_t i = 0; i < count; ++i) {
+            soaOut.xData()[i] += soaTmp.xData()[i];
+            soaOut.yData()[i] += soaTmp.yData()[i];
+        }
+    }
+    ch.Stop();
+    reportThroughput(ch, "PointBuffer kernel chain - ", count * rounds);
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        soaOut = (soa1 + soa2) * 0.5 - soa3;
+    }
+    ch.Stop();
+    reportThroughput(ch, "PointBuffer expression template - ", count * rounds);
+
+    const auto last = count - 1;
+    std::cout << "Last result AoS " << aosOut[last].xValue() << " PointBuffer " << soaOut[last].xValue() << std::endl;
+}
+
 int main() {
     constexprFuncTest();
+    powVariantsTest();
+    powSpeedTest();
     constexprClassTest();
+    pointBufferSpeedTest();
+    expressionTemplateTest();
+    expressionTemplateSpeedTest();
     
     return 0;
 }
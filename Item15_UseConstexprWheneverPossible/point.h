@@ -0,0 +1,45 @@
+#pragma once
+
+#include <type_traits>
+
+class Point {
+public:
+    constexpr Point(double xVal = 0, double yVal = 0) noexcept
+    : x(xVal), y(yVal)
+    {}
+    // evaluates a scalar expression template of pointexpr.h, e.g. Point p = (p1 + p2) * 0.5;
+    // expressions over PointBuffers have one value per element and do not convert
+    template<typename E, typename = std::enable_if_t<E::isScalar>>
+    constexpr Point(const E& expr) noexcept
+    : x(expr.xAt(0)), y(expr.yAt(0))
+    {}
+    constexpr double xValue() const noexcept { return x; }
+    constexpr double yValue() const noexcept { return y; }
+    constexpr void setX(double newX) noexcept { x = newX; }
+    constexpr void setY(double newY) noexcept { y = newY; }
+
+private:
+    double x, y;
+};
+
+constexpr
+Point midpoint(const Point& p1, const Point& p2) noexcept
+{
+    return { (p1.xValue() + p2.xValue()) / 2, // call constexpr member funcs
+                (p1.yValue() + p2.yValue()) / 2 };
+}
+
+// return reflection of p with respect to the origin (C++14)
+constexpr Point reflection(const Point& p) noexcept
+{
+    Point result; // create non-const Point
+    result.setX(-p.xValue()); // set its x and y values
+    result.setY(-p.yValue());
+    return result; // return copy of it
+}
+
+// return p moved by (dx, dy)
+constexpr Point translate(const Point& p, double dx, double dy) noexcept
+{
+    return { p.xValue() + dx, p.yValue() + dy };
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "point.h"
+
+/*
+Structure of arrays storage for many Points: all x values are contiguous, and so are all y values.
+The batch kernels below are plain index loops over raw pointers with no calls and no branches,
+which compilers vectorise (SSE/AVX, whichever the target allows) at -O3. The constexpr scalar
+functions in point.h stay the way to compute single Points during compilation.
+*/
+class PointBuffer {
+public:
+    PointBuffer() = default;
+    explicit PointBuffer(std::size_t count) : xs(count), ys(count) {}
+
+    // evaluates an expression template of pointexpr.h in one pass, e.g. PointBuffer mid = (b1 + b2) * 0.5;
+    template<typename E, typename = typename E::isPointExpression>
+    PointBuffer(const E& expr) : xs(expr.size()), ys(expr.size()) { evaluate(expr); }
+
+    template<typename E, typename = typename E::isPointExpression>
+    PointBuffer& operator=(const E& expr)
+    {
+        if (expr.size() != size()) { // expr may refer to this buffer, so do not reallocate it under expr
+            PointBuffer result(expr);
+            swap(result);
+        } else {
+            evaluate(expr); // element i only reads element i of the operands, so aliasing is fine
+        }
+        return *this;
+    }
+
+    void swap(PointBuffer& other) noexcept { xs.swap(other.xs); ys.swap(other.ys); }
+
+    std::size_t size() const noexcept { return xs.size(); }
+    void reserve(std::size_t count) { xs.reserve(count); ys.reserve(count); }
+    void resize(std::size_t count) { xs.resize(count); ys.resize(count); }
+
+    void push_back(const Point& p) { xs.push_back(p.xValue()); ys.push_back(p.yValue()); }
+
+    Point operator[](std::size_t i) const noexcept { return { xs[i], ys[i] }; }
+    void set(std::size_t i, const Point& p) noexcept { xs[i] = p.xValue(); ys[i] = p.yValue(); }
+
+    double* xData() noexcept { return xs.data(); }
+    double* yData() noexcept { return ys.data(); }
+    const double* xData() const noexcept { return xs.data(); }
+    const double* yData() const noexcept { return ys.data(); }
+
+private:
+    template<typename E>
+    void evaluate(const E& expr) noexcept
+    {
+        const std::size_t n = size();
+        double* x = xs.data();
+        double* y = ys.data();
+        for (std::size_t i = 0; i < n; ++i) x[i] = expr.xAt(i);
+        for (std::size_t i = 0; i < n; ++i) y[i] = expr.yAt(i);
+    }
+
+    std::vector<double> xs, ys;
+};
+
+// out[i] = midpoint(p1[i], p2[i]). out is resized to the input size and may alias p1 or p2.
+inline void midpoint(const PointBuffer& p1, const PointBuffer& p2, PointBuffer& out)
+{
+    assert(p1.size() == p2.size());
+    const std::size_t n = p1.size();
+    out.resize(n);
+
+    const double* x1 = p1.xData(); const double* y1 = p1.yData();
+    const double* x2 = p2.xData(); const double* y2 = p2.yData();
+    double* xo = out.xData(); double* yo = out.yData();
+    for (std::size_t i = 0; i < n; ++i) xo[i] = (x1[i] + x2[i]) / 2; // one stream per loop keeps alias checks cheap
+    for (std::size_t i = 0; i < n; ++i) yo[i] = (y1[i] + y2[i]) / 2;
+}
+
+// out[i] = reflection(p[i]). out is resized to the input size and may alias p.
+inline void reflection(const PointBuffer& p, PointBuffer& out)
+{
+    const std::size_t n = p.size();
+    out.resize(n);
+
+    const double* x = p.xData(); const double* y = p.yData();
+    double* xo = out.xData(); double* yo = out.yData();
+    for (std::size_t i = 0; i < n; ++i) xo[i] = -x[i];
+    for (std::size_t i = 0; i < n; ++i) yo[i] = -y[i];
+}
+
+// moves every point of p by (dx, dy) in place
+inline void translate(PointBuffer& p, double dx, double dy) noexcept
+{
+    const std::size_t n = p.size();
+    double* x = p.xData(); double* y = p.yData();
+    for (std::size_t i = 0; i < n; ++i) x[i] += dx;
+    for (std::size_t i = 0; i < n; ++i) y[i] += dy;
+}
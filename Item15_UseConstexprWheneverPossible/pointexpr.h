@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include "point.h"
+#include "pointbuffer.h"
+
+/*
+Expression templates for Point arithmetic. p1 + p2, p - q and s * p do not compute anything, they
+return small node objects that describe the computation. The whole expression is evaluated in one
+pass when it is converted to a Point, or assigned to a PointBuffer, so no intermediate Points or
+PointBuffers are materialised:
+
+    constexpr Point r = (p1 + p2) * 0.5 - p3;   // evaluated during compilation
+    PointBuffer out = (b1 + b2) * 0.5 - b3;     // one loop over all elements
+
+Operands can be Points, PointBuffers or other expressions. Points are stored by value (they are
+cheap, and this keeps expressions over temporaries valid and constexpr), PointBuffers by reference,
+so an expression over buffers must not outlive them. A Point operand is broadcast to every element;
+buffer operands of one expression must have the same size, which is asserted when it is built.
+Only scalar expressions, made of Points alone, convert to a Point.
+*/
+
+// Point and expression nodes are stored by value, PointBuffer by reference
+template<typename T> struct PointOperand { using type = T; };
+template<> struct PointOperand<PointBuffer> { using type = const PointBuffer&; };
+
+template<typename T, typename = void> struct isPointExpr : std::false_type {};
+template<typename T> struct isPointExpr<T, typename T::isPointExpression> : std::true_type {};
+
+template<typename T>
+struct isPointOperand : std::integral_constant<bool,
+    std::is_same<T, Point>::value || std::is_same<T, PointBuffer>::value || isPointExpr<T>::value> {};
+
+// true for operands made of Points only, which have the same value at every index
+template<typename T> struct isScalarPointOperand : std::integral_constant<bool, T::isScalar> {};
+template<> struct isScalarPointOperand<Point> : std::true_type {};
+template<> struct isScalarPointOperand<PointBuffer> : std::false_type {};
+
+constexpr double operandX(const Point& p, std::size_t) noexcept { return p.xValue(); }
+constexpr double operandY(const Point& p, std::size_t) noexcept { return p.yValue(); }
+constexpr std::size_t operandSize(const Point&) noexcept { return 0; } // broadcast, see isScalarPointOperand
+
+inline double operandX(const PointBuffer& b, std::size_t i) noexcept { return b.xData()[i]; }
+inline double operandY(const PointBuffer& b, std::size_t i) noexcept { return b.yData()[i]; }
+inline std::size_t operandSize(const PointBuffer& b) noexcept { return b.size(); }
+
+template<typename E, typename = typename E::isPointExpression>
+constexpr double operandX(const E& e, std::size_t i) noexcept { return e.xAt(i); }
+template<typename E, typename = typename E::isPointExpression>
+constexpr double operandY(const E& e, std::size_t i) noexcept { return e.yAt(i); }
+template<typename E, typename = typename E::isPointExpression>
+constexpr std::size_t operandSize(const E& e) noexcept { return e.size(); }
+
+struct PointPlus {
+    static constexpr double apply(double a, double b) noexcept { return a + b; }
+};
+
+struct PointMinus {
+    static constexpr double apply(double a, double b) noexcept { return a - b; }
+};
+
+template<typename L, typename R, typename Op>
+class PointBinaryExpr {
+public:
+    using isPointExpression = void;
+    static constexpr bool isScalar = isScalarPointOperand<L>::value && isScalarPointOperand<R>::value;
+
+    constexpr PointBinaryExpr(const L& l, const R& r) noexcept : lhs(l), rhs(r)
+    {
+        assert((isScalarPointOperand<L>::value || isScalarPointOperand<R>::value ||
+                operandSize(lhs) == operandSize(rhs)) && "point buffers of different sizes in one expression");
+    }
+
+    constexpr double xAt(std::size_t i) const noexcept { return Op::apply(operandX(lhs, i), operandX(rhs, i)); }
+    constexpr double yAt(std::size_t i) const noexcept { return Op::apply(operandY(lhs, i), operandY(rhs, i)); }
+    constexpr std::size_t size() const noexcept
+    {
+        return isScalarPointOperand<L>::value ? operandSize(rhs) : operandSize(lhs);
+    }
+
+private:
+    typename PointOperand<L>::type lhs;
+    typename PointOperand<R>::type rhs;
+};
+
+template<typename E>
+class PointScaledExpr {
+public:
+    using isPointExpression = void;
+    static constexpr bool isScalar = isScalarPointOperand<E>::value;
+
+    constexpr PointScaledExpr(const E& e, double s) noexcept : expr(e), scale(s) {}
+
+    constexpr double xAt(std::size_t i) const noexcept { return operandX(expr, i) * scale; }
+    constexpr double yAt(std::size_t i) const noexcept { return operandY(expr, i) * scale; }
+    constexpr std::size_t size() const noexcept { return operandSize(expr); }
+
+private:
+    typename PointOperand<E>::type expr;
+    double scale;
+};
+
+template<typename L, typename R,
+         typename = std::enable_if_t<isPointOperand<L>::value && isPointOperand<R>::value>>
+constexpr PointBinaryExpr<L, R, PointPlus> operator+(const L& lhs, const R& rhs) noexcept
+{
+    return { lhs, rhs };
+}
+
+template<typename L, typename R,
+         typename = std::enable_if_t<isPointOperand<L>::value && isPointOperand<R>::value>>
+constexpr PointBinaryExpr<L, R, PointMinus> operator-(const L& lhs, const R& rhs) noexcept
+{
+    return { lhs, rhs };
+}
+
+template<typename E, typename = std::enable_if_t<isPointOperand<E>::value>>
+constexpr PointScaledExpr<E> operator*(const E& e, double s) noexcept
+{
+    return { e, s };
+}
+
+template<typename E, typename = std::enable_if_t<isPointOperand<E>::value>>
+constexpr PointScaledExpr<E> operator*(double s, const E& e) noexcept
+{
+    return { e, s };
+}
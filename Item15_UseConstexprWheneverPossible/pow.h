@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+namespace ecs {
+
+constexpr int pow(int base, int exp) noexcept // C++14
+{
+    auto result = 1;
+    for (int i = 0; i < exp; ++i) result *= base;
+
+    return result;
+}
+
+// O(log exp) version of pow. Like pow, it assumes the result fits in int and treats exp <= 0 as 0.
+constexpr int powBySquaring(int base, int exp) noexcept
+{
+    auto result = 1;
+    while (exp > 0) {
+        if (exp & 1) result *= base;
+        exp >>= 1;
+        if (exp > 0) base *= base; // skip the last squaring, it may overflow although result does not
+    }
+
+    return result;
+}
+
+/*
+Overflow checked version. Throwing from a constexpr function is fine as long as the throw is not reached
+during constant evaluation; if it is reached, the code is rejected. Therefore an overflowing pow is a
+compile error in compile-time contexts and std::overflow_error at runtime.
+*/
+constexpr int checkedPow(int base, int exp)
+{
+    long long result = 1;
+    long long square = base;
+    while (exp > 0) {
+        if (exp & 1) {
+            result *= square;
+            if (result > std::numeric_limits<int>::max() || result < std::numeric_limits<int>::min()) {
+                throw std::overflow_error("ecs::checkedPow overflows int");
+            }
+        }
+        exp >>= 1;
+        if (exp > 0) {
+            square *= square;
+            if (square > std::numeric_limits<int>::max()) { // square is never negative here
+                throw std::overflow_error("ecs::checkedPow overflows int");
+            }
+        }
+    }
+
+    return static_cast<int>(result);
+}
+
+/*
+Powers of Base from Base^0 up to Base^MaxExp, generated during compilation. A table that overflows int
+does not compile since checkedPow throws while the table is constant evaluated.
+Lookups with exp > MaxExp (or exp < 0) fall back to powBySquaring.
+*/
+template<int Base, int MaxExp>
+class PowTable {
+public:
+    static_assert(MaxExp >= 0, "MaxExp must be non-negative");
+
+    constexpr PowTable() : m_values{}
+    {
+        for (int exp = 0; exp <= MaxExp; ++exp) m_values[exp] = checkedPow(Base, exp);
+    }
+
+    constexpr int operator[](int exp) const noexcept { return m_values[exp]; } // exp must be in [0, MaxExp]
+
+    constexpr int lookup(int exp) const noexcept
+    {
+        return (exp >= 0 && exp <= MaxExp) ? m_values[exp] : powBySquaring(Base, exp);
+    }
+
+    constexpr int maxExp() const noexcept { return MaxExp; }
+
+private:
+    int m_values[MaxExp + 1];
+};
+
+template<int Base, int MaxExp>
+constexpr PowTable<Base, MaxExp> pow_table{};
+
+/*
+Batch pow over runtime arrays: results[i] = powBySquaring(bases[i], exps[i]).
+Elements are processed in blocks. Each block runs the same number of squaring rounds (enough for the
+largest exponent in the block) and selects with arithmetic instead of branching, so the inner loops
+have no data dependent control flow and the compiler can vectorise them.
+*/
+inline void pow(const int* bases, const int* exps, int* results, std::size_t count) noexcept
+{
+    constexpr std::size_t kBlock = 64;
+    unsigned int square[kBlock];
+    unsigned int exp[kBlock];
+    unsigned int result[kBlock];
+
+    for (std::size_t first = 0; first < count; first += kBlock) {
+        const std::size_t n = (count - first < kBlock) ? count - first : kBlock;
+
+        unsigned int maxExp = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            square[i] = static_cast<unsigned int>(bases[first + i]);
+            exp[i] = exps[first + i] > 0 ? static_cast<unsigned int>(exps[first + i]) : 0u;
+            result[i] = 1u;
+            maxExp |= exp[i];
+        }
+
+        // unsigned arithmetic wraps instead of invoking UB, results that fit in int are exact
+        for (; maxExp != 0; maxExp >>= 1) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const unsigned int bit = exp[i] & 1u;
+                result[i] *= bit * square[i] + (1u - bit);
+                square[i] *= square[i];
+                exp[i] >>= 1;
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i) results[first + i] = static_cast<int>(result[i]);
+    }
+}
+
+}
@@ -11,11 +11,21 @@ size of std::unique_ptr objects.
 #include <string>
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <random>
+#include <cstddef>
+
+#include "Chronometer.h"
+#include "SizeClassPool.h"
+#include "DeferredReclaimer.h"
+#include "EnumFactory.h"
 
 using namespace std;
 
 enum class InvestmentType {Stock, Bond, RealEstate};
 
+constexpr std::size_t investmentTypeCount = 3;
+
 class Investment {
 public:
     Investment(int x) : m_x(x) {};
@@ -79,6 +89,168 @@ std::unique_ptr<Investment> makeInvestment(InvestmentType type, Ts&&... params)
     return nullptr;
 }
 
+// Custom deleter returning the memory to the size-class pool. dynamic_cast<void*> gives the address of the
+// most derived object, which is the address the pool handed out.
+auto delInvmtPooled = [] (Investment* pInvestment) {
+    void* memory = dynamic_cast<void*>(pInvestment);
+    pInvestment->~Investment();
+    utils::SizeClassPool::Deallocate(memory);
+};
+
+template<typename T, typename... Ts>
+T* newPooled(Ts&&... params) {
+    void* memory = utils::SizeClassPool::Allocate(sizeof(T));
+    try {
+        return new (memory) T(std::forward<Ts>(params)...);
+    } catch(...) {
+        utils::SizeClassPool::Deallocate(memory);
+        throw;
+    }
+}
+
+// Same as makeInvestmentWithCustomDel, but objects come from the pool's thread-local free lists instead of new
+template< typename... Ts>
+auto makeInvestmentPooled(InvestmentType type, Ts&&... params) {
+
+    std::unique_ptr<Investment, decltype(delInvmtPooled)> pInv(nullptr, delInvmtPooled);
+
+    if(type == InvestmentType::Stock) {
+        pInv.reset(newPooled<Stock>(std::forward<Ts>(params)...));
+    } else if (type == InvestmentType::Bond) {
+        pInv.reset(newPooled<Bond>(std::forward<Ts>(params)...));
+    } else if (type == InvestmentType::RealEstate) {
+        pInv.reset(newPooled<RealEstate>(std::forward<Ts>(params)...));
+    }
+    return pInv;
+}
+
+// Table driven makeInvestment. Types are listed in InvestmentType order; adding a type only extends this list
+using InvestmentFactory = utils::EnumFactory<InvestmentType, Investment, utils::TypeList<Stock, Bond, RealEstate>>;
+static_assert(InvestmentFactory::kSize == investmentTypeCount, "one type per InvestmentType");
+
+template< typename... Ts>
+std::unique_ptr<Investment> makeInvestmentFromTable(InvestmentType type, Ts&&... params) {
+    return InvestmentFactory::MakeUnique(type, std::forward<Ts>(params)...);
+}
+
+void factoryDispatchSpeedTest() {
+    constexpr int count = 1000000;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> typeDist(0, 2);
+    std::vector<InvestmentType> types(count);
+    for(auto& type : types) type = static_cast<InvestmentType>(typeDist(gen)); // random mix defeats branch prediction
+
+    long long sum = 0;
+    utils::Chronometer ch;
+
+    ch.Start();
+    for(int i = 0; i < count; ++i) sum += makeInvestment(types[i], i)->m_x;
+    ch.Stop();
+    ch.Report("if/else factory - ");
+
+    ch.Start();
+    for(int i = 0; i < count; ++i) sum -= makeInvestmentFromTable(types[i], i)->m_x;
+    ch.Stop();
+    ch.Report("Dispatch table factory - ");
+
+    auto unknown = makeInvestmentFromTable(static_cast<InvestmentType>(7), 1);
+    std::cout << "Checksum " << sum << ", unknown type gives " << (unknown ? "object" : "nullptr") << std::endl;
+}
+
+// Same as makeInvestmentWithCustomDel, but delInvmt runs on the reclaimer's background thread
+template< typename... Ts>
+auto makeInvestmentDeferred(utils::DeferredReclaimer& reclaimer, InvestmentType type, Ts&&... params) {
+
+    std::unique_ptr<Investment, utils::DeferredDeleter<decltype(delInvmt)>> pInv(nullptr, utils::MakeDeferredDeleter(reclaimer, delInvmt));
+
+    if(type == InvestmentType::Stock) {
+        pInv.reset(new Stock(std::forward<Ts>(params)...));
+    } else if (type == InvestmentType::Bond) {
+        pInv.reset(new Bond(std::forward<Ts>(params)...));
+    } else if (type == InvestmentType::RealEstate) {
+        pInv.reset(new RealEstate(std::forward<Ts>(params)...));
+    }
+    return pInv;
+}
+
+void deferredDeleteTest() {
+    utils::DeferredReclaimer reclaimer;
+    {
+        auto invt1 = makeInvestmentDeferred(reclaimer, InvestmentType::Bond, 8);
+        auto invt2 = makeInvestmentDeferred(reclaimer, InvestmentType::Stock, 9);
+    } // both are only queued here
+    std::cout << "Flushing reclaimer" << std::endl;
+    reclaimer.Flush(); // "Deleting 9" and "Deleting 8" are printed by the background thread before Flush returns
+    std::cout << "Flushed, destroyed " << reclaimer.Destroyed() << std::endl;
+}
+
+// Objects big enough that destroying them is noticeable on the request path
+class HeavyInvestment : public Investment {
+public:
+    HeavyInvestment(int x) : Investment(x), m_history(1000, x) {}
+    std::vector<int> m_history;
+};
+
+void deferredDeleteSpeedTest() {
+    constexpr int count = 100000;
+    auto quietDel = [](Investment* pInvestment) { delete pInvestment; };
+
+    std::vector<std::unique_ptr<Investment, decltype(quietDel)>> sync;
+    for(int i = 0; i < count; ++i) sync.emplace_back(new HeavyInvestment(i), quietDel);
+
+    utils::Chronometer ch;
+    ch.Start();
+    sync.clear();
+    ch.Stop();
+    ch.Report("Synchronous destruction on request thread - ");
+
+    utils::DeferredReclaimer reclaimer(1024);
+    using DeferredPtr = std::unique_ptr<Investment, utils::DeferredDeleter<decltype(quietDel)>>;
+    std::vector<DeferredPtr> deferred;
+    for(int i = 0; i < count; ++i) deferred.emplace_back(new HeavyInvestment(i), utils::MakeDeferredDeleter(reclaimer, quietDel));
+
+    ch.Start();
+    deferred.clear();
+    ch.Stop();
+    ch.Report("Deferred destruction, request thread part - ");
+
+    ch.Start();
+    reclaimer.Drain();
+    ch.Stop();
+    ch.Report("Deferred destruction, drain at shutdown - ");
+    std::cout << "    destroyed " << reclaimer.Destroyed() << std::endl;
+}
+
+template<typename Factory>
+void createDestroyLoop(Factory factory, const std::string& name) {
+    constexpr int batchSize = 1000;
+    constexpr int batches = 2000;
+
+    using Ptr = decltype(factory(InvestmentType::Stock, 0));
+    std::vector<Ptr> batch;
+    batch.reserve(batchSize);
+    long long sum = 0;
+
+    utils::Chronometer ch;
+    ch.Start();
+    for(int b = 0; b < batches; ++b) {
+        for(int i = 0; i < batchSize; ++i) {
+            batch.emplace_back(factory(static_cast<InvestmentType>(i % 3), i));
+        }
+        sum += batch.back()->m_x;
+        batch.clear(); // destroys the whole batch
+    }
+    ch.Stop();
+    ch.Report(name);
+    std::cout << "    checksum " << sum << std::endl;
+}
+
+void poolSpeedTest() {
+    createDestroyLoop([](InvestmentType type, int x) { return makeInvestment(type, x); }, "make_unique factory - ");
+    createDestroyLoop([](InvestmentType type, int x) { return makeInvestmentPooled(type, x); }, "Pooled factory - ");
+}
+
 int main() {
 
     auto invt1 = makeInvestmentWithCustomDel(InvestmentType::Bond, 3);
@@ -91,5 +263,12 @@ int main() {
 
     auto invt3 = makeInvestment(InvestmentType::Bond, 6); // This line will not print anything since it is not defined with custom del
 
+    auto invt4 = makeInvestmentPooled(InvestmentType::Stock, 7); // memory goes back to the pool, not to the heap
+
+    poolSpeedTest();
+    deferredDeleteTest();
+    deferredDeleteSpeedTest();
+    factoryDispatchSpeedTest();
+
     return 0;
 }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+#include "IntrusivePtr.h"
+
+enum class InvestmentType {Stock, Bond, RealEstate};
+
+constexpr std::size_t investmentTypeCount = 3;
+
+// Investments carry their own reference count, so they can also be held by utils::intrusive_ptr
+class Investment : public utils::RefCounted<Investment> {
+public:
+    Investment(int x) : m_x(x) {};
+    virtual ~Investment() = default;
+    int m_x;
+};
+
+class Stock : public Investment {
+public:
+    Stock(int x) : Investment(x) {}
+};
+
+class Bond : public Investment {
+public:
+    Bond(int x) : Investment(x) {}
+};
+
+class RealEstate : public Investment {
+public:
+    RealEstate(int x) :Investment(x) {}
+};
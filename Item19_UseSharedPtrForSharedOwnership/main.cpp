@@ -15,33 +15,22 @@ The type of the deleter has no effect on the type of the std::shared_ptr.
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include "Chronometer.h"
+#include "SizeClassPool.h"
+#include "LocalSharedPtr.h"
+#include "IntrusivePtr.h"
+#include "DeferredReclaimer.h"
+#include "EnumFactory.h"
+#include "investment.h"
+#include "portfolio.h"
 
 using namespace std;
 
-enum class InvestmentType {Stock, Bond, RealEstate};
-
-class Investment {
-public:
-    Investment(int x) : m_x(x) {};
-    virtual ~Investment() = default;
-    int m_x;
-};
-
-class Stock : public Investment {
-public:
-    Stock(int x) : Investment(x) {}
-};
-
-class Bond : public Investment {
-public:
-    Bond(int x) : Investment(x) {}
-};
-
-class RealEstate : public Investment {
-public:
-    RealEstate(int x) :Investment(x) {}
-};
-
 // Custom deleter
 auto delInvmt = [] (Investment* pInvestment) {
     std::cout << "Deleting " << pInvestment->m_x << std::endl;
@@ -74,6 +63,63 @@ std::shared_ptr<Investment> makeInvestment(InvestmentType type, Ts&&... params)
     return nullptr;
 }
 
+// Table driven makeInvestment. Types are listed in InvestmentType order; adding a type only extends this list
+using InvestmentFactory = utils::EnumFactory<InvestmentType, Investment, utils::TypeList<Stock, Bond, RealEstate>>;
+static_assert(InvestmentFactory::kSize == investmentTypeCount, "one type per InvestmentType");
+
+template< typename... Ts>
+std::shared_ptr<Investment> makeInvestmentFromTable(InvestmentType type, Ts&&... params) {
+    return InvestmentFactory::MakeShared(type, std::forward<Ts>(params)...);
+}
+
+// Custom deleter returning the memory to the size-class pool. dynamic_cast<void*> gives the address of the
+// most derived object, which is the address the pool handed out.
+auto delInvmtPooled = [] (Investment* pInvestment) {
+    void* memory = dynamic_cast<void*>(pInvestment);
+    pInvestment->~Investment();
+    utils::SizeClassPool::Deallocate(memory);
+};
+
+template<typename T, typename... Ts>
+T* newPooled(Ts&&... params) {
+    void* memory = utils::SizeClassPool::Allocate(sizeof(T));
+    try {
+        return new (memory) T(std::forward<Ts>(params)...);
+    } catch(...) {
+        utils::SizeClassPool::Deallocate(memory);
+        throw;
+    }
+}
+
+// Object and control block both come from the pool. If the control block cannot be allocated, shared_ptr calls the deleter
+template< typename... Ts>
+std::shared_ptr<Investment> makeInvestmentWithCustomDelPooled(InvestmentType type, Ts&&... params) {
+
+    const utils::PoolAllocator<Investment> alloc;
+    if(type == InvestmentType::Stock) {
+        return std::shared_ptr<Investment>(newPooled<Stock>(std::forward<Ts>(params)...), delInvmtPooled, alloc);
+    } else if (type == InvestmentType::Bond) {
+        return std::shared_ptr<Investment>(newPooled<Bond>(std::forward<Ts>(params)...), delInvmtPooled, alloc);
+    } else if (type == InvestmentType::RealEstate) {
+        return std::shared_ptr<Investment>(newPooled<RealEstate>(std::forward<Ts>(params)...), delInvmtPooled, alloc);
+    }
+    return nullptr;
+}
+
+// allocate_shared counterpart of makeInvestment, one pooled block holds the object and the control block
+template< typename... Ts>
+std::shared_ptr<Investment> makeInvestmentPooled(InvestmentType type, Ts&&... params) {
+
+    if(type == InvestmentType::Stock) {
+        return std::allocate_shared<Stock>(utils::PoolAllocator<Stock>{}, std::forward<Ts>(params)...);
+    } else if (type == InvestmentType::Bond) {
+        return std::allocate_shared<Bond>(utils::PoolAllocator<Bond>{}, std::forward<Ts>(params)...);
+    } else if (type == InvestmentType::RealEstate) {
+        return std::allocate_shared<RealEstate>(utils::PoolAllocator<RealEstate>{}, std::forward<Ts>(params)...);
+    }
+    return nullptr;
+}
+
 void customDelTest() {
     auto invt1 = makeInvestmentWithCustomDel(InvestmentType::Bond, 3);
     {
@@ -82,6 +128,17 @@ void customDelTest() {
     }
 
     auto invt4 = makeInvestment(InvestmentType::Bond, 5);
+    auto invt5 = makeInvestmentFromTable(InvestmentType::RealEstate, 6);
+}
+
+void deferredDeleteTest() {
+    utils::DeferredReclaimer reclaimer;
+    {
+        auto invt1 = std::shared_ptr<Investment>(new Bond(11), utils::MakeDeferredDeleter(reclaimer, delInvmt));
+        auto invt2 = invt1;
+    } // last reference dropped, Bond is only queued here
+    reclaimer.Flush(); // "Deleting 11" is printed by the background thread
+    std::cout << "Flushed, destroyed " << reclaimer.Destroyed() << std::endl;
 }
 
 void seperateCustomDelTest() {
@@ -105,10 +162,238 @@ void seperateCustomDelTest() {
     vpw[0] = vpw[1]; // shared ptr in index 0 deleted here
 }
 
+// seperateCustomDelTest with single-threaded, non-atomic counted pointers
+void localSharedPtrTest() {
+
+    auto customDel1 = [](Investment* inv) {
+        std::cout << "Local custom del 1  -  " << inv->m_x << std::endl;
+        delete inv;
+    };
+
+    auto pw1 = utils::local_shared_ptr<Investment>(new Bond(10), customDel1);
+    utils::local_shared_ptr<Investment> pw2 = utils::make_local_shared<Stock>(20);
+    utils::local_weak_ptr<Investment> wpw(pw1);
+
+    std::vector<utils::local_shared_ptr<Investment>> vpw;
+    vpw.emplace_back(std::move(pw1));
+    vpw.emplace_back(std::move(pw2));
+    vpw[0] = vpw[1]; // Bond deleted here
+    std::cout << "Bond expired: " << wpw.expired() << ", Stock use count: " << vpw[1].use_count() << std::endl;
+
+    utils::local_shared_ptr<Investment> pw3 = utils::allocate_local_shared<Bond>(utils::PoolAllocator<Bond>{}, 30);
+    std::cout << "Pooled local Bond " << pw3->m_x << std::endl;
+}
+
+template<typename Ptr>
+void copyDestroyLoop(const std::vector<Ptr>& source, const std::string& name) {
+    constexpr int rounds = 1000;
+
+    std::vector<Ptr> copies;
+    copies.reserve(source.size()); // keep vector allocation out of the measurement
+    long long sum = 0;
+    utils::Chronometer ch;
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        copies.assign(source.begin(), source.end()); // one count increment per element
+        sum += copies.back()->m_x;
+        copies.clear(); // one count decrement per element
+    }
+    ch.Stop();
+    ch.Report(name);
+    std::cout << "    checksum " << sum << std::endl;
+}
+
+void localSharedPtrSpeedTest() {
+    constexpr int count = 10000;
+    auto quietDel = [](Investment* pInvestment) { delete pInvestment; }; // delInvmt without printing
+
+    std::vector<std::shared_ptr<Investment>> shared;
+    std::vector<utils::local_shared_ptr<Investment>> local;
+    for(int i = 0; i < count; ++i) {
+        shared.emplace_back(new Bond(i), quietDel);
+        local.emplace_back(new Bond(i), quietDel);
+    }
+
+    copyDestroyLoop(shared, "std::shared_ptr vector copy, single-threaded process - ");
+    // libstdc++ skips the atomic instructions while the process has a single thread, so start one to see their cost
+    std::thread([] {}).join();
+    copyDestroyLoop(shared, "std::shared_ptr vector copy - ");
+    copyDestroyLoop(local, "utils::local_shared_ptr vector copy - ");
+}
+
+// Release hook for RefCounted: destroys the object and gives its memory back to the size-class pool
+struct PoolRelease {
+    template<typename T>
+    static void Release(const T* p) noexcept {
+        p->~T();
+        utils::SizeClassPool::Deallocate(const_cast<void*>(static_cast<const void*>(p)));
+    }
+};
+
+// Non-atomic count, pooled memory. Must only be shared within one thread
+class LocalPosition : public utils::RefCounted<LocalPosition, utils::LocalRefCount, PoolRelease> {
+public:
+    explicit LocalPosition(int x) : m_x(x) {}
+    int m_x;
+};
+
+// std::allocator that records the bytes it hands out
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+    static std::size_t bytes;
+
+    CountingAllocator() = default;
+    template<typename U> CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        CountingAllocator<char>::bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) noexcept { std::allocator<T>().deallocate(p, n); }
+};
+template<typename T> std::size_t CountingAllocator<T>::bytes = 0;
+template<typename T, typename U>
+bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) noexcept { return true; }
+template<typename T, typename U>
+bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) noexcept { return false; }
+
+void intrusivePtrTest() {
+    utils::intrusive_ptr<Investment> ip1 = utils::make_intrusive<Stock>(40);
+    auto ip2 = ip1;
+    std::cout << "Intrusive Stock use count " << ip1->use_count() << std::endl;
+
+    utils::intrusive_ptr<LocalPosition> lp(newPooled<LocalPosition>(50)); // released into the pool
+
+    auto sp = std::allocate_shared<Stock>(CountingAllocator<Stock>{}, 60);
+    std::cout << "Pointer size:     std::shared_ptr " << sizeof(sp) << " bytes, utils::intrusive_ptr " << sizeof(ip1) << " bytes" << std::endl;
+    std::cout << "Memory per Stock: make_shared block " << CountingAllocator<char>::bytes
+              << " bytes, intrusive object " << sizeof(Stock) << " bytes (count included)" << std::endl;
+}
+
+void intrusivePtrSpeedTest() {
+    constexpr int count = 10000;
+
+    std::vector<std::shared_ptr<Investment>> shared;
+    std::vector<utils::intrusive_ptr<Investment>> intrusive;
+    std::vector<utils::intrusive_ptr<LocalPosition>> local;
+    for(int i = 0; i < count; ++i) {
+        shared.emplace_back(std::make_shared<Stock>(i));
+        intrusive.emplace_back(utils::make_intrusive<Stock>(i));
+        local.emplace_back(newPooled<LocalPosition>(i));
+    }
+
+    std::thread([] {}).join(); // make sure libstdc++ uses atomic counts for std::shared_ptr
+    copyDestroyLoop(shared, "make_shared vector copy - ");
+    copyDestroyLoop(intrusive, "intrusive_ptr (atomic count) vector copy - ");
+    copyDestroyLoop(local, "intrusive_ptr (local count) vector copy - ");
+}
+
+template<typename Factory>
+void createDestroyLoop(Factory factory, const std::string& name) {
+    constexpr int batchSize = 1000;
+    constexpr int batches = 2000;
+
+    std::vector<std::shared_ptr<Investment>> batch;
+    batch.reserve(batchSize);
+    long long sum = 0;
+
+    utils::Chronometer ch;
+    ch.Start();
+    for(int b = 0; b < batches; ++b) {
+        for(int i = 0; i < batchSize; ++i) {
+            batch.emplace_back(factory(static_cast<InvestmentType>(i % 3), i));
+        }
+        sum += batch.back()->m_x;
+        batch.clear(); // destroys the whole batch
+    }
+    ch.Stop();
+    ch.Report(name);
+    std::cout << "    checksum " << sum << std::endl;
+}
+
+void poolSpeedTest() {
+    auto quietDel = [](Investment* pInvestment) { delete pInvestment; }; // delInvmt without printing
+    createDestroyLoop([&](InvestmentType type, int x) {
+        if(type == InvestmentType::Stock) return std::shared_ptr<Investment>(new Stock(x), quietDel);
+        if(type == InvestmentType::Bond) return std::shared_ptr<Investment>(new Bond(x), quietDel);
+        return std::shared_ptr<Investment>(new RealEstate(x), quietDel);
+    }, "new with custom deleter - ");
+    createDestroyLoop([](InvestmentType type, int x) { return makeInvestmentWithCustomDelPooled(type, x); }, "Pooled with custom deleter - ");
+    createDestroyLoop([](InvestmentType type, int x) { return makeInvestment(type, x); }, "make_shared factory - ");
+    createDestroyLoop([](InvestmentType type, int x) { return makeInvestmentPooled(type, x); }, "allocate_shared on pool factory - ");
+}
+
+void portfolioTest() {
+    Portfolio portfolio;
+    auto bond = portfolio.add(InvestmentType::Bond, 10);
+    portfolio.add(InvestmentType::Bond, 30);
+    auto stock = portfolio.add(InvestmentType::Stock, 20);
+
+    portfolio.remove(bond); // moves the bond of 30 into the hole, stock handle is unaffected
+    portfolio.setValue(stock, 25);
+    std::cout << "Bond sum " << portfolio.sum(InvestmentType::Bond) << ", stock " << portfolio.value(stock) << std::endl;
+
+    auto newBond = portfolio.add(InvestmentType::Bond, 40); // reuses the slot of the removed bond
+    std::cout << "Removed bond handle valid " << portfolio.contains(bond) << ", new one " << portfolio.contains(newBond) << std::endl;
+}
+
+void portfolioSpeedTest() {
+    constexpr std::size_t positions = 10000000;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> typeDist(0, investmentTypeCount - 1);
+    std::uniform_int_distribution<int> valueDist(-1000, 1000);
+
+    std::vector<std::shared_ptr<Investment>> objects;
+    objects.reserve(positions);
+    Portfolio portfolio;
+    for(std::size_t i = 0; i < positions; ++i) {
+        const auto type = static_cast<InvestmentType>(typeDist(gen));
+        const int x = valueDist(gen);
+        objects.emplace_back(makeInvestment(type, x));
+        portfolio.add(type, x);
+    }
+    std::shuffle(objects.begin(), objects.end(), gen); // positions are rarely in allocation order after churn
+
+    utils::Chronometer ch;
+
+    ch.Start();
+    long long objectsTotal = 0;
+    for(const auto& inv : objects) objectsTotal += inv->m_x;
+    ch.Stop();
+    ch.Report("Sum over vector of shared_ptr - ");
+
+    ch.Start();
+    const long long portfolioTotal = portfolio.sum();
+    ch.Stop();
+    ch.Report("Sum over Portfolio columns - ");
+
+    ch.Start();
+    int lowest = std::numeric_limits<int>::max();
+    int highest = std::numeric_limits<int>::min();
+    for(std::size_t t = 0; t < investmentTypeCount; ++t) {
+        lowest = std::min(lowest, portfolio.min(static_cast<InvestmentType>(t)));
+        highest = std::max(highest, portfolio.max(static_cast<InvestmentType>(t)));
+    }
+    ch.Stop();
+    ch.Report("Min and max per type over Portfolio columns - ");
+
+    std::cout << "Totals " << objectsTotal << " " << portfolioTotal << ", range " << lowest << " " << highest << std::endl;
+}
+
 int main() {
 
     customDelTest();
     seperateCustomDelTest();
+    deferredDeleteTest();
+    poolSpeedTest();
+    portfolioTest();
+    portfolioSpeedTest();
+    localSharedPtrTest();
+    localSharedPtrSpeedTest();
+    intrusivePtrTest();
+    intrusivePtrSpeedTest();
     
     return 0;
 }
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "investment.h"
+
+/*
+Data oriented alternative to std::vector<std::shared_ptr<Investment>>.
+Positions are stored column-wise: one contiguous array of m_x values per InvestmentType, no
+virtual objects, no control blocks and no pointer hop per position. Aggregates are linear scans
+over a column, which compilers vectorise, so valuing a portfolio is bound by memory bandwidth.
+
+Handles stay valid until their position is removed. Removal moves the last value of the column
+into the hole, so a handle goes through a small slot table to find its current index. Slots are
+reused, and each slot counts its removals: a handle remembers that generation, so a handle to a
+removed position is recognised by contains() even after its slot went to a new position, and using
+it fails an assertion instead of reaching the new position.
+*/
+class Portfolio {
+public:
+    struct Handle {
+        InvestmentType type;
+        std::uint32_t slot;
+        std::uint32_t generation;
+    };
+
+    void reserve(InvestmentType type, std::size_t count)
+    {
+        Column& c = column(type);
+        c.values.reserve(count);
+        c.denseToSlot.reserve(count);
+        c.slotToDense.reserve(count);
+        c.slotGeneration.reserve(count);
+    }
+
+    Handle add(InvestmentType type, int x)
+    {
+        Column& c = column(type);
+        std::uint32_t slot;
+        if (c.freeSlots.empty()) {
+            slot = static_cast<std::uint32_t>(c.slotToDense.size());
+            c.slotToDense.push_back(0);
+            c.slotGeneration.push_back(0);
+        } else {
+            slot = c.freeSlots.back();
+            c.freeSlots.pop_back();
+        }
+        c.slotToDense[slot] = static_cast<std::uint32_t>(c.values.size());
+        c.values.push_back(x);
+        c.denseToSlot.push_back(slot);
+        return { type, slot, c.slotGeneration[slot] };
+    }
+
+    // false once h's position has been removed
+    bool contains(Handle h) const
+    {
+        const Column& c = column(h.type);
+        return h.slot < c.slotGeneration.size() && c.slotGeneration[h.slot] == h.generation;
+    }
+
+    // h must not have been removed before
+    void remove(Handle h)
+    {
+        assert(contains(h) && "stale Portfolio handle");
+        Column& c = column(h.type);
+        const std::uint32_t index = c.slotToDense[h.slot];
+        const std::uint32_t last = static_cast<std::uint32_t>(c.values.size() - 1);
+
+        c.values[index] = c.values[last];
+        c.denseToSlot[index] = c.denseToSlot[last];
+        c.slotToDense[c.denseToSlot[index]] = index;
+
+        c.values.pop_back();
+        c.denseToSlot.pop_back();
+        ++c.slotGeneration[h.slot]; // handles to the removed position are stale from now on
+        c.freeSlots.push_back(h.slot);
+    }
+
+    int value(Handle h) const
+    {
+        assert(contains(h) && "stale Portfolio handle");
+        return column(h.type).values[column(h.type).slotToDense[h.slot]];
+    }
+
+    void setValue(Handle h, int x)
+    {
+        assert(contains(h) && "stale Portfolio handle");
+        column(h.type).values[column(h.type).slotToDense[h.slot]] = x;
+    }
+
+    std::size_t size(InvestmentType type) const noexcept { return column(type).values.size(); }
+
+    std::size_t size() const noexcept
+    {
+        std::size_t total = 0;
+        for (const auto& c : columns) total += c.values.size();
+        return total;
+    }
+
+    // contiguous m_x values of one type, in no particular order
+    const int* values(InvestmentType type) const noexcept { return column(type).values.data(); }
+
+    long long sum(InvestmentType type) const noexcept
+    {
+        const int* x = values(type);
+        const std::size_t n = size(type);
+        long long total = 0;
+        for (std::size_t i = 0; i < n; ++i) total += x[i];
+        return total;
+    }
+
+    long long sum() const noexcept
+    {
+        long long total = 0;
+        for (std::size_t t = 0; t < investmentTypeCount; ++t) total += sum(static_cast<InvestmentType>(t));
+        return total;
+    }
+
+    // numeric_limits<int>::max() for a type without positions
+    int min(InvestmentType type) const noexcept
+    {
+        const int* x = values(type);
+        const std::size_t n = size(type);
+        int result = std::numeric_limits<int>::max();
+        for (std::size_t i = 0; i < n; ++i) result = x[i] < result ? x[i] : result;
+        return result;
+    }
+
+    // numeric_limits<int>::min() for a type without positions
+    int max(InvestmentType type) const noexcept
+    {
+        const int* x = values(type);
+        const std::size_t n = size(type);
+        int result = std::numeric_limits<int>::min();
+        for (std::size_t i = 0; i < n; ++i) result = x[i] > result ? x[i] : result;
+        return result;
+    }
+
+private:
+    struct Column {
+        std::vector<int> values;
+        std::vector<std::uint32_t> denseToSlot; // values[i] belongs to handle slot denseToSlot[i]
+        std::vector<std::uint32_t> slotToDense;
+        std::vector<std::uint32_t> slotGeneration; // removals from each slot
+        std::vector<std::uint32_t> freeSlots;
+    };
+
+    Column& column(InvestmentType type) noexcept
+    {
+        assert(static_cast<std::size_t>(type) < investmentTypeCount);
+        return columns[static_cast<std::size_t>(type)];
+    }
+
+    const Column& column(InvestmentType type) const noexcept
+    {
+        assert(static_cast<std::size_t>(type) < investmentTypeCount);
+        return columns[static_cast<std::size_t>(type)];
+    }
+
+    std::array<Column, investmentTypeCount> columns;
+};
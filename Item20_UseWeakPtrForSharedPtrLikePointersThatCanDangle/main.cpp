@@ -9,16 +9,33 @@ prevention of std::shared_ptr cycles.
 #include <iostream>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+#include <atomic>
+
+#include "Chronometer.h"
+#include "WeakCache.h"
+#include "SingleFlight.h"
+#include "widgetstore.h"
 
 using namespace std;
 
 class Widget {
 public:
     Widget(int id) : m_id(id) {}
+    // View of a record in a widget file, the record is not copied
+    explicit Widget(const WidgetRecord* record) : m_id(record->id), m_record(record) {}
     ~Widget() noexcept { std::cout << "Widget " << m_id << " destructor called" << std::endl;};
 
+    const WidgetRecord* record() const { return m_record; } // nullptr if not loaded from a file
+
 private:
     int m_id;
+    const WidgetRecord* m_record = nullptr;
 };
 
 void weakPtrTest() {
@@ -49,12 +66,42 @@ void badWeakPtrTest() {
     }
 }
 
+#ifdef UTILS_HAS_MAPPED_FILE
+constexpr std::size_t storedWidgetCount = 1 << 12; // 1 MiB
+
+// Opened on the first load. The file lives as long as the process, widgets keep its mapping
+const MappedWidgetStore& widgetStore() {
+    static const TempWidgetFile file(storedWidgetCount);
+    static const MappedWidgetStore store(file.path());
+    return store;
+}
+#endif
+
+// Widgets are views of records in the mapped widget file, ids the file does not have get a bare Widget
 std::shared_ptr<const Widget> loadWidget(int id) {
+#ifdef UTILS_HAS_MAPPED_FILE
+    const auto& store = widgetStore();
+    if(auto record = store.find(id)) {
+        // the deleter lives in the control block and keeps the file mapped until the Widget is destroyed
+        return std::shared_ptr<const Widget>(new const Widget(record), [file = store.file()](const Widget* w) mutable {
+            delete w;
+            file.reset(); // weak_ptrs keep the control block, not the mapping
+        });
+    }
+#endif
     return make_shared<const Widget>(id);
 }
 
-// Quick and dirty implementation for caching Widget ptrs
-std::shared_ptr<const Widget> fastLoadWidget(int id) {
+// Batched loadWidget, a backing store fetches all ids in one round trip. Results are in ids order
+std::vector<std::shared_ptr<const Widget>> loadWidgets(const int* ids, std::size_t count) {
+    std::vector<std::shared_ptr<const Widget>> widgets;
+    widgets.reserve(count);
+    for(std::size_t i = 0; i < count; ++i) widgets.emplace_back(loadWidget(ids[i]));
+    return widgets;
+}
+
+// Quick and dirty implementation for caching Widget ptrs. Not thread safe, and expired entries stay in the map forever
+std::shared_ptr<const Widget> quickLoadWidget(int id) {
     static std::unordered_map<int, std::weak_ptr<const Widget>> cache;
 
     auto objPtr = cache[id].lock(); // look at the cache if Widget is created before
@@ -67,15 +114,338 @@ std::shared_ptr<const Widget> fastLoadWidget(int id) {
     return objPtr;
 }
 
+utils::WeakCache<int, const Widget>& widgetCache() {
+    static utils::WeakCache<int, const Widget> cache;
+    return cache;
+}
+
+// Concurrent misses on one id share a single loadWidget call, widgetLoads().Shared() counts the deduplicated ones
+utils::SingleFlight<int, std::shared_ptr<const Widget>>& widgetLoads() {
+    static utils::SingleFlight<int, std::shared_ptr<const Widget>> loads;
+    return loads;
+}
+
+// Thread-safe version of quickLoadWidget, expired entries are swept as new ids come in
+std::shared_ptr<const Widget> fastLoadWidget(int id) {
+    auto& cache = widgetCache();
+
+    if(auto objPtr = cache.Find(id)) {
+        return objPtr;
+    }
+
+    return widgetLoads().Do(id, [&] {
+        if(auto objPtr = cache.Find(id)) { // a load that finished after our Find but before our Do
+            return objPtr;
+        }
+        return cache.Insert(id, loadWidget(id));
+    });
+}
+
+// fastLoadWidget for many ids at once: each cache shard is locked once, and the distinct misses are
+// loaded with a single loadWidgets call. Misses go through widgetLoads() like fastLoadWidget's, so an
+// id being loaded by another call is waited for, not loaded again. Results are in ids order
+std::vector<std::shared_ptr<const Widget>> fastLoadWidgets(const int* ids, std::size_t count) {
+    auto& cache = widgetCache();
+    return cache.GetOrLoadMany(ids, count, [&](const int* missed, std::size_t missedCount) {
+        return widgetLoads().DoMany(missed, missedCount, [&](const int* claimed, std::size_t claimedCount) {
+            // loads that finished after our lookup but before DoMany, as in fastLoadWidget
+            std::vector<std::shared_ptr<const Widget>> widgets(claimedCount);
+            std::vector<int> toLoad;
+            std::vector<std::size_t> toLoadIndex;
+            for(std::size_t i = 0; i < claimedCount; ++i) {
+                widgets[i] = cache.Find(claimed[i]);
+                if(!widgets[i]) {
+                    toLoad.push_back(claimed[i]);
+                    toLoadIndex.push_back(i);
+                }
+            }
+            auto loaded = loadWidgets(toLoad.data(), toLoad.size());
+            for(std::size_t k = 0; k < toLoad.size(); ++k) widgets[toLoadIndex[k]] = cache.Insert(toLoad[k], std::move(loaded[k]));
+            return widgets;
+        });
+    });
+}
+
+void quickCacheTest() {
+    auto spw1 = quickLoadWidget(1);
+    auto spw2 = quickLoadWidget(1); // a hit, the same Widget
+    std::cout << "quickLoadWidget returns the cached Widget " << (spw1 == spw2) << std::endl;
+}
+
 void cacheTest() {
     auto spw1 = fastLoadWidget(4);
     auto spw2 = fastLoadWidget(5);
     auto spw3 = fastLoadWidget(5); // Destructor of 5 is called only once since it is cached
+    std::cout << "Widget 5 views its mapped record " << (spw2->record() != nullptr) << std::endl;
+}
+
+void batchLoadTest() {
+    auto spw = fastLoadWidget(7);
+    const int ids[] = {7, 8, 9, 8};
+    auto widgets = fastLoadWidgets(ids, 4); // 7 is a hit, 8 and 9 are loaded once each
+    std::cout << "Batch of 4: first is cached " << (widgets[0] == spw) << ", duplicates share one Widget "
+              << (widgets[1] == widgets[3]) << std::endl;
+}
+
+void singleFlightTest() {
+    utils::SingleFlight<int, std::shared_ptr<const int>> loads;
+    std::atomic<int> loaderCalls{0};
+
+    auto slowLoad = [&](int id) {
+        return loads.Do(id, [&] {
+            ++loaderCalls;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50)); // expensive I/O
+            if(id < 0) throw std::invalid_argument("no such id");
+            return std::make_shared<const int>(id);
+        });
+    };
+
+    std::vector<std::thread> threads;
+    std::atomic<int> failures{0};
+    for(int t = 0; t < 4; ++t) threads.emplace_back([&] { slowLoad(42); });
+    for(int t = 0; t < 4; ++t) threads.emplace_back([&] {
+        try {
+            slowLoad(-1);
+        } catch(const std::invalid_argument&) {
+            ++failures; // every waiter sees the loader's exception
+        }
+    });
+    for(auto& th : threads) th.join();
+
+    std::cout << "Loader calls " << loaderCalls << " for 8 requests, deduplicated " << loads.Shared()
+              << ", failures seen " << failures << std::endl;
+
+    auto spw = fastLoadWidget(6);
+    std::cout << "fastLoadWidget loads " << widgetLoads().Executed() << ", deduplicated " << widgetLoads().Shared() << std::endl;
+}
+
+// quickLoadWidget with one mutex around the map, the straightforward way to make it thread safe
+class SingleLockCache {
+public:
+    std::shared_ptr<const int> getOrLoad(int id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto objPtr = m_cache[id].lock();
+        if(!objPtr) {
+            objPtr = std::make_shared<const int>(id);
+            m_cache[id] = objPtr;
+        }
+        return objPtr;
+    }
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_cache.size();
+    }
+private:
+    std::mutex m_mutex;
+    std::unordered_map<int, std::weak_ptr<const int>> m_cache;
+};
+
+// Half of the lookups hit ids that are kept alive, the others ask for ids never seen before (churn),
+// which are dropped right after the lookup and leave expired entries behind
+template<typename LookUp>
+void runMixedLookups(LookUp lookUp, const std::string& name) {
+    constexpr int threadCount = 4;
+    constexpr int lookUpsPerThread = 500000;
+    constexpr int pinnedRange = 1 << 15;
+
+    std::vector<std::shared_ptr<const int>> pinned;
+    for(int id = 0; id < pinnedRange; ++id) pinned.emplace_back(lookUp(id));
+
+    utils::Chronometer ch;
+    ch.Start();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&lookUp, t] {
+            std::mt19937 gen(t);
+            std::uniform_int_distribution<int> idDist(0, pinnedRange - 1);
+            for(int i = 0; i < lookUpsPerThread; ++i) {
+                lookUp((i & 1) ? pinnedRange + i * threadCount + t : idDist(gen));
+            }
+        });
+    }
+    for(auto& th : threads) th.join();
+    ch.Stop();
+    ch.Report(name);
+}
+
+void weakCacheSpeedTest() {
+    SingleLockCache singleLock;
+    runMixedLookups([&](int id) { return singleLock.getOrLoad(id); }, "Single mutex weak map - ");
+    std::cout << "    entries " << singleLock.size() << std::endl;
+
+    utils::WeakCache<int, const int> sharded;
+    runMixedLookups([&](int id) {
+        return sharded.GetOrLoad(id, [](int key) { return std::make_shared<const int>(key); });
+    }, "Sharded WeakCache - ");
+    const auto stats = sharded.GetStats();
+    std::cout << "    entries " << stats.entries << ", hits " << stats.hits << ", misses " << stats.misses << std::endl;
+}
+
+// Payload that keeps track of how many instances are alive
+class Blob {
+public:
+    explicit Blob(int id) : m_id(id) { ++alive; }
+    ~Blob() { --alive; }
+    static int alive;
+private:
+    int m_id;
+    char m_data[1020];
+};
+int Blob::alive = 0;
+
+// Callers drop every object right after using it, so only the strong tier can keep hot ids alive between bursts
+void strongTierTest() {
+    constexpr int idCount = 10000;
+    constexpr int lookUps = 1000000;
+
+    std::vector<double> weights(idCount);
+    for(int i = 0; i < idCount; ++i) weights[i] = 1.0 / (i + 1); // Zipf, s = 1
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+
+    for(std::size_t capacity : {0, 64, 256, 1024}) {
+        utils::WeakCache<int, const Blob> cache(16, capacity);
+        std::mt19937 gen(42);
+
+        utils::Chronometer ch;
+        ch.Start();
+        for(int i = 0; i < lookUps; ++i) {
+            cache.GetOrLoad(zipf(gen), [](int id) { return std::make_shared<const Blob>(id); });
+        }
+        ch.Stop();
+        ch.Report("Strong tier of " + std::to_string(capacity) + " - ");
+
+        const auto stats = cache.GetStats();
+        std::cout << "    hit rate " << 100.0 * stats.hits / lookUps << "%, pinned " << stats.pinned
+                  << ", live objects " << Blob::alive << " (" << Blob::alive * sizeof(Blob) / 1024 << " KiB)" << std::endl;
+    }
+}
+
+// Busy waits like a call to a backing store: a fixed round trip plus a small cost per fetched id
+void storeCall(std::size_t idCount) {
+    const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(2) + std::chrono::nanoseconds(100) * idCount;
+    while(std::chrono::steady_clock::now() < end) {}
+}
+
+// Request handlers asking for 200 ids at a time, each keeps its results until the next request
+void batchLoadSpeedTest() {
+    constexpr int idCount = 100000;
+    constexpr int batchSize = 200;
+    constexpr int batches = 5000;
+
+    std::vector<double> weights(idCount);
+    for(int i = 0; i < idCount; ++i) weights[i] = 1.0 / (i + 1);
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+    std::mt19937 gen(7);
+    std::vector<int> trace(batches * batchSize);
+    for(auto& id : trace) id = zipf(gen);
+
+    auto load = [](int id) {
+        storeCall(1);
+        return std::make_shared<const int>(id);
+    };
+    auto loadMany = [](const int* ids, std::size_t count) {
+        storeCall(count);
+        std::vector<std::shared_ptr<const int>> values;
+        values.reserve(count);
+        for(std::size_t i = 0; i < count; ++i) values.emplace_back(std::make_shared<const int>(ids[i]));
+        return values;
+    };
+
+    {
+        utils::WeakCache<int, const int> cache(16, 1024);
+        std::vector<std::shared_ptr<const int>> held;
+        utils::Chronometer ch;
+        ch.Start();
+        for(int b = 0; b < batches; ++b) {
+            std::vector<std::shared_ptr<const int>> results;
+            results.reserve(batchSize);
+            for(int i = 0; i < batchSize; ++i) results.emplace_back(cache.GetOrLoad(trace[b * batchSize + i], load));
+            held.swap(results);
+        }
+        ch.Stop();
+        ch.Report("Per id GetOrLoad - ");
+        const auto stats = cache.GetStats();
+        std::cout << "    store calls " << stats.misses << std::endl;
+    }
+    {
+        utils::WeakCache<int, const int> cache(16, 1024);
+        std::vector<std::shared_ptr<const int>> held;
+        std::size_t storeCalls = 0;
+        utils::Chronometer ch;
+        ch.Start();
+        for(int b = 0; b < batches; ++b) {
+            auto results = cache.GetOrLoadMany(&trace[b * batchSize], batchSize, [&](const int* ids, std::size_t count) {
+                ++storeCalls;
+                return loadMany(ids, count);
+            });
+            held.swap(results);
+        }
+        ch.Stop();
+        ch.Report("Batched GetOrLoadMany - ");
+        std::cout << "    store calls " << storeCalls << std::endl;
+    }
+}
+
+#ifdef UTILS_HAS_MAPPED_FILE
+// What a caller does with a loaded widget
+std::uint64_t useRecord(const WidgetRecord& record) {
+    return record.payloadSize + record.payload[0] + record.payload[sizeof(record.payload) - 1];
+}
+
+template<typename Load>
+void runStoreLoads(const std::vector<int>& ids, Load load, const std::string& name) {
+    std::uint64_t checksum = 0;
+    utils::Chronometer ch;
+    ch.Start();
+    for(int id : ids) checksum += load(id);
+    ch.Stop();
+    ch.Report(name);
+    std::cout << "    checksum " << checksum << std::endl;
+}
+
+// Random loads from a 64 MiB widget file: cold after its pages were dropped from the page cache, then warm
+void widgetStoreSpeedTest() {
+    constexpr std::size_t widgetFileRecords = 1 << 18;
+    TempWidgetFile file(widgetFileRecords); // removed at the end of the test
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> idDist(0, widgetFileRecords - 1);
+    std::vector<int> ids(200000);
+    for(auto& id : ids) id = idDist(gen);
+
+    utils::MappedFile::DropPageCache(file.path());
+    {
+        MappedWidgetStore store(file.path()); // a fresh mapping, no page is mapped yet
+        runStoreLoads(ids, [&](int id) { return useRecord(*store.find(id)); }, "mmap store, cold - ");
+        runStoreLoads(ids, [&](int id) { return useRecord(*store.find(id)); }, "mmap store, warm - ");
+    }
+
+    utils::MappedFile::DropPageCache(file.path());
+    {
+        ReadWidgetStore store(file.path());
+        auto load = [&](int id) {
+            WidgetRecord record;
+            store.read(id, record);
+            return useRecord(record);
+        };
+        runStoreLoads(ids, load, "pread store, cold - ");
+        runStoreLoads(ids, load, "pread store, warm - ");
+    }
 }
+#endif
 
 int main() {
     weakPtrTest();
     badWeakPtrTest();
+    quickCacheTest();
     cacheTest();
+    weakCacheSpeedTest();
+    singleFlightTest();
+    strongTierTest();
+    batchLoadTest();
+    batchLoadSpeedTest();
+#ifdef UTILS_HAS_MAPPED_FILE
+    widgetStoreSpeedTest();
+#endif
     return 0;
 }
\ No newline at end of file
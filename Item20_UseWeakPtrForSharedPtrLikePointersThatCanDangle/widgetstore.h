@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include "MappedFile.h"
+
+/*
+Widget file layout: a header followed by fixed size records, the record of id i at index i, so a
+lookup is an offset computation. Records are trivially copyable and aligned in the file, which
+lets a mapped store hand out pointers straight into the mapping.
+*/
+struct WidgetRecord {
+    std::int32_t id;
+    std::uint32_t payloadSize;
+    char payload[248];
+};
+static_assert(std::is_trivially_copyable<WidgetRecord>::value, "records are used in place");
+static_assert(sizeof(WidgetRecord) == 256, "record size is part of the file format");
+
+struct WidgetFileHeader {
+    char magic[8];
+    std::uint32_t recordSize;
+    std::uint32_t reserved;
+    std::uint64_t recordCount;
+    char padding[232]; // records start on a record boundary
+};
+static_assert(sizeof(WidgetFileHeader) == sizeof(WidgetRecord), "header takes one record slot");
+
+constexpr char widgetFileMagic[8] = {'W', 'I', 'D', 'G', 'E', 'T', 'S', '1'};
+
+inline WidgetRecord makeWidgetRecord(int id)
+{
+    WidgetRecord record{};
+    record.id = id;
+    record.payloadSize = sizeof(record.payload);
+    for(std::size_t i = 0; i < sizeof(record.payload); ++i) {
+        record.payload[i] = static_cast<char>(id + i);
+    }
+    return record;
+}
+
+#ifdef UTILS_HAS_MAPPED_FILE
+
+#include <fcntl.h>
+#include <stdlib.h> // mkstemp
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+Widget file with records for ids [0, count), created with a unique name by mkstemp, so nothing else
+can have it open or swap it for a symlink, and removed by the destructor. The records are synced to
+disk, the pages must be clean to be dropped from the page cache. Throws std::system_error on failure.
+*/
+class TempWidgetFile {
+public:
+    explicit TempWidgetFile(std::size_t count)
+    {
+        const char* dir = std::getenv("TMPDIR");
+        m_path = std::string(dir && *dir ? dir : "/tmp") + "/widgetsXXXXXX";
+        const int fd = ::mkstemp(&m_path[0]);
+        if(fd < 0) throw std::system_error(errno, std::generic_category(), "mkstemp " + m_path);
+
+        auto fail = [&](const char* what) {
+            const int error = errno;
+            ::close(fd);
+            ::unlink(m_path.c_str());
+            throw std::system_error(error, std::generic_category(), what + (" " + m_path));
+        };
+        auto writeAll = [&](const void* data, std::size_t size) {
+            if(::write(fd, data, size) != static_cast<ssize_t>(size)) fail("write");
+        };
+
+        WidgetFileHeader header{};
+        std::memcpy(header.magic, widgetFileMagic, sizeof(header.magic));
+        header.recordSize = sizeof(WidgetRecord);
+        header.recordCount = count;
+        writeAll(&header, sizeof(header));
+
+        constexpr std::size_t chunk = 256;
+        WidgetRecord records[chunk];
+        for(std::size_t first = 0; first < count; first += chunk) {
+            const std::size_t n = count - first < chunk ? count - first : chunk;
+            for(std::size_t i = 0; i < n; ++i) records[i] = makeWidgetRecord(static_cast<int>(first + i));
+            writeAll(records, n * sizeof(WidgetRecord));
+        }
+        if(::fsync(fd) != 0) fail("fsync");
+        ::close(fd);
+    }
+
+    TempWidgetFile(const TempWidgetFile&) = delete;
+    TempWidgetFile& operator=(const TempWidgetFile&) = delete;
+
+    ~TempWidgetFile() { ::unlink(m_path.c_str()); }
+
+    const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+};
+
+// True if a file of fileSize bytes holds the header and all the records it announces
+inline bool isValidWidgetFile(const WidgetFileHeader& header, std::uint64_t fileSize)
+{
+    return std::memcmp(header.magic, widgetFileMagic, sizeof(widgetFileMagic)) == 0 &&
+           header.recordSize == sizeof(WidgetRecord) &&
+           fileSize >= sizeof(WidgetFileHeader) &&
+           header.recordCount <= (fileSize - sizeof(WidgetFileHeader)) / sizeof(WidgetRecord); // no overflow
+}
+
+/*
+Store backed by a read-only mapping of a widget file. find() returns a pointer into the mapping:
+nothing is copied and nothing is read up front, a record's page is read from disk the first time
+the record is touched. The pointers stay valid while any copy of file() is alive.
+*/
+class MappedWidgetStore {
+public:
+    explicit MappedWidgetStore(const std::string& path)
+        : m_file(std::make_shared<const utils::MappedFile>(path))
+    {
+        if(m_file->Size() < sizeof(WidgetFileHeader)) throw std::runtime_error("widget file too short: " + path);
+        auto header = reinterpret_cast<const WidgetFileHeader*>(m_file->Data());
+        if(!isValidWidgetFile(*header, m_file->Size())) throw std::runtime_error("not a widget file: " + path);
+        m_count = static_cast<std::size_t>(header->recordCount);
+        m_records = reinterpret_cast<const WidgetRecord*>(m_file->Data() + sizeof(WidgetFileHeader));
+        m_file->AdviseRandom();
+    }
+
+    // nullptr if the file has no record for id
+    const WidgetRecord* find(int id) const
+    {
+        if(id < 0 || static_cast<std::size_t>(id) >= m_count) return nullptr;
+        return m_records + id;
+    }
+
+    std::size_t size() const { return m_count; }
+    const std::shared_ptr<const utils::MappedFile>& file() const { return m_file; }
+
+private:
+    std::shared_ptr<const utils::MappedFile> m_file;
+    const WidgetRecord* m_records = nullptr;
+    std::size_t m_count = 0;
+};
+
+// The traditional way: every load is a pread() of the record into a buffer owned by the caller
+class ReadWidgetStore {
+public:
+    explicit ReadWidgetStore(const std::string& path)
+        : m_fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC))
+    {
+        if(m_fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+        WidgetFileHeader header;
+        struct stat st;
+        if(::fstat(m_fd, &st) != 0 ||
+           ::pread(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+           !isValidWidgetFile(header, static_cast<std::uint64_t>(st.st_size))) {
+            ::close(m_fd);
+            throw std::runtime_error("not a widget file: " + path);
+        }
+        m_count = static_cast<std::size_t>(header.recordCount);
+    }
+
+    ReadWidgetStore(const ReadWidgetStore&) = delete;
+    ReadWidgetStore& operator=(const ReadWidgetStore&) = delete;
+
+    ~ReadWidgetStore() { ::close(m_fd); }
+
+    // false if the file has no record for id
+    bool read(int id, WidgetRecord& record) const
+    {
+        if(id < 0 || static_cast<std::size_t>(id) >= m_count) return false;
+        const off_t offset = sizeof(WidgetFileHeader) + static_cast<off_t>(id) * sizeof(WidgetRecord);
+        return ::pread(m_fd, &record, sizeof(record), offset) == static_cast<ssize_t>(sizeof(record));
+    }
+
+    std::size_t size() const { return m_count; }
+
+private:
+    int m_fd;
+    std::size_t m_count = 0;
+};
+
+#endif // UTILS_HAS_MAPPED_FILE
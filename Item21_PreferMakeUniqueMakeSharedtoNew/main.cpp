@@ -39,8 +39,37 @@ std::shared_ptr and the last std::weak_ptr referring to it have been destroyed.
 
 #include <vector>
 #include <memory>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <iostream>
+#include <string>
 
 #include "Chronometer.h"
+#include "MonotonicArena.h"
+#include "RetentionTracker.h"
+
+// Counts every trip to the global heap and the bytes currently allocated. Each block starts with a
+// header holding its size
+static std::size_t heapAllocations = 0;
+static std::size_t heapBytes = 0;
+constexpr std::size_t heapHeaderSize = alignof(std::max_align_t);
+
+void* operator new(std::size_t size) {
+    ++heapAllocations;
+    auto block = static_cast<char*>(std::malloc(heapHeaderSize + size));
+    if(!block) throw std::bad_alloc();
+    *reinterpret_cast<std::size_t*>(block) = size;
+    heapBytes += size;
+    return block + heapHeaderSize;
+}
+void operator delete(void* p) noexcept {
+    if(!p) return;
+    auto block = static_cast<char*>(p) - heapHeaderSize;
+    heapBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
 
 class Widget {
 public:
@@ -51,29 +80,96 @@ private:
     int m_id;
 };
 
-void speedTest() {
-    std::vector<std::shared_ptr<Widget>> vec1;
-    vec1.reserve(1000);
+// Creates count shared_ptrs one at a time with make, then destroys them all. Prints time and heap allocations
+template<typename Make>
+void runSharedPtrLoop(int count, Make make, const std::string& name) {
+    std::vector<std::shared_ptr<Widget>> vec;
+    vec.reserve(count);
 
+    const std::size_t allocationsBefore = heapAllocations;
     utils::Chronometer ch;
     ch.Start();
-    for(int i = 0; i < 1000; ++i) {
-        vec1.emplace_back(std::make_shared<Widget>(3));
+    for(int i = 0; i < count; ++i) {
+        vec.emplace_back(make(i));
     }
+    vec.clear();
     ch.Stop();
-    ch.Report("Make shared - ");
+    const std::size_t allocations = heapAllocations - allocationsBefore; // before the report allocates its strings
+    ch.Report(name + std::to_string(count) + " objects ");
+    std::cout << "    heap allocations " << allocations << std::endl;
+}
+
+void speedTest() {
+    utils::MonotonicArena arena;
+
+    for(int count : {1000, 10000, 100000, 1000000, 10000000}) {
+        runSharedPtrLoop(count, [](int id) { return std::make_shared<Widget>(id); }, "Make shared - ");
+        runSharedPtrLoop(count, [](int id) { return std::shared_ptr<Widget>(new Widget(id)); }, "From raw pointer - ");
+        runSharedPtrLoop(count, [&](int id) {
+            return std::allocate_shared<Widget>(utils::ArenaAllocator<Widget>(arena), id);
+        }, "Allocate shared on arena - ");
+        arena.Reset(); // every Widget is gone, the blocks are reused by the next round
+    }
+    std::cout << "Arena blocks allocated in total " << arena.BlockAllocations() << ", capacity " << arena.Capacity() / 1024 << " KiB" << std::endl;
+
+    std::vector<int, utils::ArenaAllocator<int>> ids{utils::ArenaAllocator<int>(arena)}; // containers work too
+    for(int i = 0; i < 1000; ++i) ids.push_back(i);
+}
 
-    vec1.clear();
+// Large object, e.g. a decoded image held by a cache of weak_ptrs
+class BigWidget {
+public:
+    explicit BigWidget(int id) : m_id(id) {}
+private:
+    int m_id;
+    char m_pixels[64 * 1024];
+};
+
+// Creates count BigWidgets with make, keeps only weak_ptrs to them, as Item20's cache does, and
+// prints the heap memory that is still held once every shared_ptr is gone. That is every allocation
+// made meanwhile, including the bookkeeping of a RetentionTracker make reports to
+template<typename Make>
+std::vector<std::weak_ptr<BigWidget>> runWeakCacheScenario(int count, Make make, const std::string& name) {
+    const std::size_t bytesBefore = heapBytes;
+    std::vector<std::weak_ptr<BigWidget>> cache;
+    cache.reserve(count);
 
+    utils::Chronometer ch;
     ch.Start();
-    for(int i = 0; i < 1000; ++i) {
-        vec1.emplace_back(std::shared_ptr<Widget>(new Widget(3)));
-    }
+    for(int i = 0; i < count; ++i) {
+        auto widget = make(i);
+        cache.emplace_back(widget);
+    } // the only shared_ptr dies here
     ch.Stop();
-    ch.Report("From raw pointer - ");
+    ch.Report(name);
+    std::cout << "    heap bytes still held, all allocations " << heapBytes - bytesBefore - count * sizeof(std::weak_ptr<BigWidget>) << std::endl;
+    return cache;
+}
+
+void retentionTest() {
+    constexpr int count = 1000;
+    utils::RetentionTracker tracker;
+
+    auto combined = runWeakCacheScenario(count, [&](int id) {
+        return std::allocate_shared<BigWidget>(utils::RetentionAllocator<BigWidget>(tracker, UTILS_ALLOCATION_SITE), id);
+    }, "allocate_shared, object and control block together - ");
+    std::size_t retainedBytes = 0;
+    for(auto& site : tracker.Report()) retainedBytes += site.retained_bytes;
+    std::cout << "    of which held by expired weak_ptrs " << retainedBytes << ", the rest is the tracker's own map" << std::endl;
+    auto separate = runWeakCacheScenario(count, [](int id) {
+        return std::shared_ptr<BigWidget>(new BigWidget(id));
+    }, "shared_ptr(new), separate control block - ");
+
+    std::cout << "Retention report:" << std::endl;
+    tracker.Print(std::cout);
+
+    combined.resize(count / 2); // the weak_ptrs going away finally free the blocks
+    std::cout << "After dropping half of the weak_ptrs:" << std::endl;
+    tracker.Print(std::cout);
 }
 
 int main() {
     speedTest();
+    retentionTest();
     return 0;
 }
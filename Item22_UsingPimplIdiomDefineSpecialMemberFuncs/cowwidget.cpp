@@ -0,0 +1,39 @@
+#include <vector>
+#include <string>
+
+#include "cowwidget.h"
+
+struct CowWidget::Impl {
+    std::string name;
+    std::vector<double> data;
+};
+
+CowWidget::CowWidget() {
+    pImpl.Mutable().name = "Hi ne dedin!";
+}
+
+CowWidget::CowWidget(std::size_t dataSize) {
+    auto& impl = pImpl.Mutable(); // not shared yet, no copy
+    impl.name = "Hi ne dedin!";
+    impl.data.assign(dataSize, 1.0);
+}
+
+CowWidget::~CowWidget() = default;
+
+CowWidget::CowWidget(CowWidget&& rhs) = default;
+
+CowWidget& CowWidget::operator=(CowWidget&& rhs) = default;
+
+CowWidget::CowWidget(const CowWidget& rhs) = default;
+
+CowWidget& CowWidget::operator=(const CowWidget& rhs) = default;
+
+double CowWidget::sum() const {
+    double result = 0;
+    for(double d : pImpl->data) result += d;
+    return result;
+}
+
+void CowWidget::scale(double factor) {
+    for(double& d : pImpl.Mutable().data) d *= factor;
+}
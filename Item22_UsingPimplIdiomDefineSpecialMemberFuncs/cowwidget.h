@@ -0,0 +1,24 @@
+#include <cstddef>
+
+#include "CowPimpl.h"
+
+// Widget whose copies share one Impl until one of them is modified
+class CowWidget {
+public: 
+    CowWidget();
+    explicit CowWidget(std::size_t dataSize); // data filled with dataSize values
+    ~CowWidget();
+
+    CowWidget(CowWidget&& rhs);
+    CowWidget& operator=(CowWidget&& rhs);
+
+    CowWidget(const CowWidget& rhs); // shares rhs's Impl, nothing is copied
+    CowWidget& operator=(const CowWidget& rhs);
+
+    double sum() const; // reads data
+    void scale(double factor); // modifies data, detaches from the other copies first
+
+private:
+    struct Impl;
+    utils::cow_pimpl<Impl> pImpl;
+};
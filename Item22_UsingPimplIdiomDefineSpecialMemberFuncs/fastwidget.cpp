@@ -0,0 +1,26 @@
+#include <vector>
+#include <string>
+
+#include "fastwidget.h"
+
+struct FastWidget::Impl {
+    std::string name;
+    std::vector<double> data;
+};
+
+FastWidget::FastWidget() {
+    pImpl->name = "Hi ne dedin!";
+}
+
+FastWidget::~FastWidget() {
+    static_assert(sizeof(Impl) <= kImplSize, "FastWidget::kImplSize is too small for Impl");
+    static_assert(kImplAlign % alignof(Impl) == 0, "FastWidget::kImplAlign does not fit Impl");
+}
+
+FastWidget::FastWidget(FastWidget&& rhs) = default;
+
+FastWidget& FastWidget::operator=(FastWidget&& rhs) = default;
+
+FastWidget::FastWidget(const FastWidget& rhs) = default; // copies Impl in place, no allocation for the Impl itself
+
+FastWidget& FastWidget::operator=(const FastWidget& rhs) = default;
@@ -0,0 +1,21 @@
+#include "FastPimpl.h"
+
+// Widget with its Impl stored inside the object instead of on the heap. The storage is a fixed
+// budget, so Impl can change without touching this header; fastwidget.cpp checks that Impl fits
+class FastWidget {
+public: 
+    FastWidget();
+    ~FastWidget(); // as with unique_ptr, Impl is complete only in the implementation file
+
+    FastWidget(FastWidget&& rhs);
+    FastWidget& operator=(FastWidget&& rhs);
+
+    FastWidget(const FastWidget& rhs);
+    FastWidget& operator=(const FastWidget& rhs);
+
+private:
+    struct Impl;
+    static constexpr std::size_t kImplSize = 8 * sizeof(void*);
+    static constexpr std::size_t kImplAlign = alignof(std::max_align_t);
+    utils::fast_pimpl<Impl, kImplSize, kImplAlign> pImpl;
+};
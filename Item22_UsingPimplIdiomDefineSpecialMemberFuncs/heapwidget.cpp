@@ -0,0 +1,73 @@
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+#include "heapwidget.h"
+#include "widgetserial.h"
+
+struct HeapWidget::Impl {
+    std::string name;
+    std::vector<double> data;
+};
+
+HeapWidget::HeapWidget()
+: pImpl(std::make_unique<Impl>()) {
+    pImpl->name = "Hi ne dedin!";
+}
+
+HeapWidget::HeapWidget(std::size_t dataSize)
+: pImpl(std::make_unique<Impl>()) {
+    pImpl->name = "Hi ne dedin!";
+    pImpl->data.assign(dataSize, 1.0);
+}
+
+HeapWidget::HeapWidget(const WidgetView& view)
+: pImpl(std::make_unique<Impl>()) {
+    pImpl->name.assign(view.name(), view.nameSize());
+    pImpl->data.assign(view.data(), view.data() + view.dataSize());
+}
+
+HeapWidget::~HeapWidget() = default;
+
+HeapWidget::HeapWidget(HeapWidget&& rhs) = default;
+
+HeapWidget& HeapWidget::operator=(HeapWidget&& rhs) = default;
+
+HeapWidget::HeapWidget(const HeapWidget& rhs)
+: pImpl(std::make_unique<Impl>(*rhs.pImpl)) {
+}
+
+HeapWidget& HeapWidget::operator=(const HeapWidget& rhs) {
+    *pImpl = *rhs.pImpl;
+    return *this;
+}
+
+double HeapWidget::sum() const {
+    double result = 0;
+    for(double d : pImpl->data) result += d;
+    return result;
+}
+
+std::size_t HeapWidget::serializedSize() const {
+    return widgetRecordSize(pImpl->name.size(), pImpl->data.size());
+}
+
+char* HeapWidget::serialize(char* out) const {
+    return writeWidgetRecord(out, pImpl->name.data(), pImpl->name.size(), pImpl->data.data(), pImpl->data.size());
+}
+
+std::ostream& operator<<(std::ostream& os, const HeapWidget& widget) {
+    os << widget.pImpl->name << '\n' << widget.pImpl->data.size();
+    for(double d : widget.pImpl->data) os << ' ' << d;
+    return os << '\n';
+}
+
+std::istream& operator>>(std::istream& is, HeapWidget& widget) {
+    std::getline(is >> std::ws, widget.pImpl->name);
+    std::size_t count = 0;
+    is >> count;
+    widget.pImpl->data.resize(count);
+    for(double& d : widget.pImpl->data) is >> d;
+    return is;
+}
@@ -0,0 +1,34 @@
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+
+class WidgetView;
+
+// Widget without the prints of its copy operations, the unique_ptr pimpl baseline of the benchmarks
+class HeapWidget {
+public: 
+    HeapWidget();
+    explicit HeapWidget(std::size_t dataSize); // data filled with dataSize values
+    explicit HeapWidget(const WidgetView& view); // copies a serialized widget out of its buffer
+    ~HeapWidget();
+
+    HeapWidget(HeapWidget&& rhs);
+    HeapWidget& operator=(HeapWidget&& rhs);
+
+    HeapWidget(const HeapWidget& rhs);
+    HeapWidget& operator=(const HeapWidget& rhs);
+
+    double sum() const; // reads data
+
+    // Binary record of widgetserial.h: serializedSize() is a multiple of 8, out must be 8-byte aligned
+    std::size_t serializedSize() const;
+    char* serialize(char* out) const; // returns the end of the record
+
+    // Text format: the name on one line, then the data count and the data separated by spaces on the next
+    friend std::ostream& operator<<(std::ostream& os, const HeapWidget& widget);
+    friend std::istream& operator>>(std::istream& is, HeapWidget& widget);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
@@ -8,7 +8,155 @@ if the default function implementations are acceptable.
 • The above advice applies to std::unique_ptr, but not to std::shared_ptr.
  */
 
+#include <vector>
+#include <string>
+#include <utility>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <iomanip>
+#include <random>
+
+#include "Chronometer.h"
 #include "widget.h"
+#include "heapwidget.h"
+#include "fastwidget.h"
+#include "cowwidget.h"
+#include "widgetserial.h"
+
+// Construct, copy, move and destroy count widgets. The widgets are defined in other translation
+// units, so nothing is inlined away
+template<typename W>
+void pimplSpeedTest(const std::string& name) {
+    constexpr int count = 1000000;
+    utils::Chronometer ch;
+
+    ch.Start();
+    std::vector<W> widgets(count);
+    ch.Stop();
+    ch.Report(name + "construct ");
+
+    ch.Start();
+    std::vector<W> copies(widgets);
+    ch.Stop();
+    ch.Report(name + "copy ");
+
+    std::vector<W> moved;
+    moved.reserve(count);
+    ch.Start();
+    for(auto& w : copies) moved.emplace_back(std::move(w));
+    ch.Stop();
+    ch.Report(name + "move ");
+
+    ch.Start();
+    widgets.clear();
+    copies.clear();
+    moved.clear();
+    ch.Stop();
+    ch.Report(name + "destroy ");
+}
+
+// Hands out copies of one widget with a large data vector, every copy is passed to modify and read
+template<typename W, typename Modify>
+void copyHeavySpeedTest(Modify modify, const std::string& name) {
+    constexpr int copyCount = 1000;
+    const W original(100000);
+
+    double total = 0;
+    utils::Chronometer ch;
+    ch.Start();
+    std::vector<W> copies;
+    copies.reserve(copyCount);
+    for(int i = 0; i < copyCount; ++i) {
+        copies.emplace_back(original);
+        modify(copies.back(), i);
+        total += copies.back().sum();
+    }
+    ch.Stop();
+    ch.Report(name);
+    std::cout << "    total " << total << std::endl;
+}
+
+void reportGBs(utils::Chronometer& ch, std::size_t bytes, const std::string& name) {
+    const double seconds = std::chrono::duration<double>(ch.Elapsed()).count();
+    ch.Report(name);
+    std::cout << "    " << bytes / seconds / 1e9 << " GB/s" << std::endl;
+}
+
+// Round trips HeapWidgets with random data, binary records against the text operators. Both go through
+// in-memory streams, so the formats are measured and not the disk
+void serializationSpeedTest() {
+    constexpr int widgetCount = 50;
+    constexpr std::size_t dataSize = 100000;
+    const std::string name = "Hi ne dedin!";
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> valueDist(-1000.0, 1000.0);
+    std::vector<double> values(dataSize);
+    std::vector<std::uint64_t> record(widgetRecordSize(name.size(), dataSize) / sizeof(std::uint64_t));
+    std::vector<HeapWidget> widgets;
+    widgets.reserve(widgetCount);
+    for(int i = 0; i < widgetCount; ++i) {
+        for(auto& v : values) v = valueDist(gen);
+        auto out = reinterpret_cast<char*>(record.data());
+        writeWidgetRecord(out, name.data(), name.size(), values.data(), values.size());
+        widgets.emplace_back(WidgetView(out));
+    }
+    const std::size_t payload = widgetCount * dataSize * sizeof(double);
+
+    utils::Chronometer ch;
+    std::ostringstream binary(std::ios::binary);
+    ch.Start();
+    {
+        WidgetStreamWriter writer(binary);
+        for(auto& w : widgets) writer.write(w);
+    }
+    ch.Stop();
+    reportGBs(ch, payload, "Binary write - ");
+    {
+        const std::string bytes = binary.str();
+        std::vector<std::uint64_t> buffer(bytes.size() / sizeof(std::uint64_t)); // 8-byte aligned, like an mmap
+        std::memcpy(buffer.data(), bytes.data(), bytes.size());
+        double total = 0;
+        ch.Start();
+        WidgetRecordReader reader(buffer.data(), bytes.size());
+        WidgetView view;
+        while(reader.next(view)) {
+            const double* data = view.data();
+            for(std::size_t i = 0; i < view.dataSize(); ++i) total += data[i];
+        }
+        ch.Stop();
+        reportGBs(ch, payload, "Binary read in place - ");
+        std::cout << "    total " << total << std::endl;
+
+        total = 0;
+        ch.Start();
+        WidgetRecordReader widgetReader(buffer.data(), bytes.size());
+        while(widgetReader.next(view)) {
+            HeapWidget w(view);
+            total += w.sum();
+        }
+        ch.Stop();
+        reportGBs(ch, payload, "Binary read into HeapWidget - ");
+        std::cout << "    total " << total << std::endl;
+    }
+
+    std::stringstream text;
+    text << std::setprecision(17); // round trips every double
+    ch.Start();
+    for(auto& w : widgets) text << w;
+    ch.Stop();
+    reportGBs(ch, payload, "iostream write - ");
+    {
+        double total = 0;
+        HeapWidget w;
+        ch.Start();
+        while(text >> w) total += w.sum();
+        ch.Stop();
+        reportGBs(ch, payload, "iostream read into HeapWidget - ");
+        std::cout << "    total " << total << std::endl;
+    }
+}
 
 int main() {
 
@@ -21,5 +169,26 @@ int main() {
     Widget w4;
     w4 = w3;
 
+    FastWidget fw;
+    FastWidget fw2(std::move(fw));
+    FastWidget fw3(fw2);
+    fw = fw3;
+
+    pimplSpeedTest<HeapWidget>("unique_ptr pimpl - ");
+    pimplSpeedTest<FastWidget>("fast_pimpl - ");
+
+    CowWidget cw(10);
+    CowWidget cw2(cw); // shares cw's Impl
+    cw2.scale(3.0);    // cw2 gets its own copy, cw is untouched
+    std::cout << "Copy-on-write: original sum " << cw.sum() << ", modified copy sum " << cw2.sum() << std::endl;
+
+    copyHeavySpeedTest<HeapWidget>([](HeapWidget&, int) {}, "Deep copy, read only - ");
+    copyHeavySpeedTest<CowWidget>([](CowWidget&, int) {}, "Copy-on-write, read only - ");
+    copyHeavySpeedTest<CowWidget>([](CowWidget& w, int i) {
+        if(i % 10 == 0) w.scale(2.0);
+    }, "Copy-on-write, every 10th copy modified - ");
+
+    serializationSpeedTest();
+
     return 0;
 }
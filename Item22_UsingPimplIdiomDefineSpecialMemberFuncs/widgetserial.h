@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/*
+Binary layout of a serialized Widget, read in place without parsing:
+
+    WidgetRecordHeader  16 bytes: magic, name size, data count
+    name                nameSize bytes, not null terminated
+    padding             up to the next multiple of 8
+    data                dataCount doubles, native byte order
+
+Every record is a multiple of 8 bytes long, so records can be written back to back and, if the
+buffer starts 8-byte aligned (heap memory, an mmap), data() of every record is a properly aligned
+double array.
+*/
+struct WidgetRecordHeader {
+    std::uint32_t magic;
+    std::uint32_t nameSize;
+    std::uint64_t dataCount;
+};
+
+constexpr std::uint32_t widgetRecordMagic = 0x31444957; // "WID1"
+constexpr std::size_t widgetRecordAlignment = alignof(double);
+
+inline std::size_t alignWidgetRecord(std::size_t size)
+{
+    return (size + widgetRecordAlignment - 1) & ~(widgetRecordAlignment - 1);
+}
+
+inline std::size_t widgetRecordSize(std::size_t nameSize, std::size_t dataCount)
+{
+    return alignWidgetRecord(sizeof(WidgetRecordHeader) + nameSize) + dataCount * sizeof(double);
+}
+
+// Writes one record at out, which must be aligned; returns the end of the record
+inline char* writeWidgetRecord(char* out, const char* name, std::size_t nameSize, const double* data, std::size_t dataCount)
+{
+    WidgetRecordHeader header{widgetRecordMagic, static_cast<std::uint32_t>(nameSize), dataCount};
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), name, nameSize);
+    const std::size_t dataOffset = alignWidgetRecord(sizeof(header) + nameSize);
+    std::memset(out + sizeof(header) + nameSize, 0, dataOffset - sizeof(header) - nameSize);
+    std::memcpy(out + dataOffset, data, dataCount * sizeof(double));
+    return out + dataOffset + dataCount * sizeof(double);
+}
+
+// View of a record in memory: the name and the doubles are used where they are, nothing is copied
+class WidgetView {
+public:
+    WidgetView() = default;
+    explicit WidgetView(const char* record)
+        : m_record(record)
+    {
+        std::memcpy(&m_header, record, sizeof(m_header));
+    }
+
+    const char* name() const { return m_record + sizeof(WidgetRecordHeader); }
+    std::size_t nameSize() const { return m_header.nameSize; }
+    const double* data() const { return reinterpret_cast<const double*>(m_record + alignWidgetRecord(sizeof(WidgetRecordHeader) + m_header.nameSize)); }
+    std::size_t dataSize() const { return m_header.dataCount; }
+    std::size_t recordSize() const { return widgetRecordSize(m_header.nameSize, m_header.dataCount); }
+
+private:
+    const char* m_record = nullptr;
+    WidgetRecordHeader m_header{};
+};
+
+// Walks records written back to back. Throws std::runtime_error on a misaligned or corrupt buffer
+class WidgetRecordReader {
+public:
+    WidgetRecordReader(const void* buffer, std::size_t size)
+        : m_next(static_cast<const char*>(buffer)), m_end(m_next + size)
+    {
+        if(reinterpret_cast<std::uintptr_t>(buffer) % widgetRecordAlignment != 0) throw std::runtime_error("widget records must be 8-byte aligned");
+    }
+
+    // false at the end of the buffer
+    bool next(WidgetView& view)
+    {
+        if(m_next == m_end) return false;
+        if(static_cast<std::size_t>(m_end - m_next) < sizeof(WidgetRecordHeader)) throw std::runtime_error("truncated widget record");
+        WidgetView record(m_next);
+        WidgetRecordHeader header;
+        std::memcpy(&header, m_next, sizeof(header));
+        if(header.magic != widgetRecordMagic) throw std::runtime_error("not a widget record");
+        if(header.dataCount > (static_cast<std::size_t>(m_end - m_next) / sizeof(double)) ||
+           record.recordSize() > static_cast<std::size_t>(m_end - m_next)) {
+            throw std::runtime_error("truncated widget record");
+        }
+        m_next += record.recordSize();
+        view = record;
+        return true;
+    }
+
+private:
+    const char* m_next;
+    const char* m_end;
+};
+
+// Writes records to a stream through a buffer, so a batch of small widgets turns into few large writes.
+// Widget needs serializedSize() and serialize(char* out), like HeapWidget
+class WidgetStreamWriter {
+public:
+    explicit WidgetStreamWriter(std::ostream& os, std::size_t bufferSize = 1 << 20)
+        : m_os(os), m_buffer(alignWidgetRecord(bufferSize) / sizeof(std::uint64_t))
+    {}
+
+    WidgetStreamWriter(const WidgetStreamWriter&) = delete;
+    WidgetStreamWriter& operator=(const WidgetStreamWriter&) = delete;
+
+    ~WidgetStreamWriter() { flush(); }
+
+    template<typename Widget>
+    void write(const Widget& widget)
+    {
+        const std::size_t size = widget.serializedSize();
+        if(m_used + size > capacity()) {
+            flush();
+            if(size > capacity()) m_buffer.resize(size / sizeof(std::uint64_t)); // records are multiples of 8
+        }
+        widget.serialize(buffer() + m_used);
+        m_used += size;
+    }
+
+    void flush()
+    {
+        m_os.write(buffer(), m_used);
+        m_used = 0;
+    }
+
+private:
+    char* buffer() { return reinterpret_cast<char*>(m_buffer.data()); }
+    std::size_t capacity() const { return m_buffer.size() * sizeof(std::uint64_t); }
+
+    std::ostream& m_os;
+    std::vector<std::uint64_t> m_buffer; // 8-byte aligned
+    std::size_t m_used = 0;
+};
@@ -9,6 +9,14 @@ to an rvalue.
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "Chronometer.h"
+#include "Tracked.h"
+#include "ShardedCounter.h"
 
 using namespace std;
 
@@ -44,45 +52,41 @@ void forwardTest() {
     std::cout << st2 << std::endl; // At this point, st2 is no longer available since it is moved to another object in PROCESS function
 }
 
-// Same classes with different move operation
+// Same classes with different move operation, Tracked counts how often their strings are moved
 class Widget1 {
 public:
+    using String = utils::Tracked<std::string, Widget1>;
+
     Widget1() = default;
     ~Widget1() = default;
 
     Widget1(Widget1&& rhs)  // uconventional, undesirable implementation
-    : s(std::forward<std::string>(rhs.s)){
-        ++moveCtorCalls;
+    : s(std::forward<String>(rhs.s)){
     }
 
-    void print(){ std::cout << moveCtorCalls << std::endl;}
+    void print(){ std::cout << String::Counts().move_constructed << std::endl;}
 
 private:
-    static std::size_t moveCtorCalls;
-    std::string s;
+    String s;
 };
 
 class Widget2 {
     public:
+    using String = utils::Tracked<std::string, Widget2>;
+
     Widget2() = default;
     ~Widget2() = default;
     
     Widget2(Widget2&& rhs) 
     : s(std::move(rhs.s)){ // requires less typing than std::forward
-        moveCtorCalls = rhs.moveCtorCalls;
-        ++moveCtorCalls;
     }
 
-    void print(){ std::cout << moveCtorCalls << std::endl;}
+    void print(){ std::cout << String::Counts().move_constructed << std::endl;}
 
 private:
-    static std::size_t moveCtorCalls;
-    std::string s;
+    String s;
 };
 
-std::size_t Widget1::moveCtorCalls = 0;
-std::size_t Widget2::moveCtorCalls = 0;
-
 void moveCtorTest() {
     Widget1 w1_1;
 
@@ -96,10 +100,84 @@ void moveCtorTest() {
     w2_3.print(); // two times move operation
 }
 
+// A string whose move constructor may throw, so std::vector copies it when it grows
+struct ThrowingMoveString {
+    ThrowingMoveString(const char* str) : s(str) {}
+    ThrowingMoveString(const ThrowingMoveString&) = default;
+    ThrowingMoveString(ThrowingMoveString&& rhs) : s(std::move(rhs.s)) {}
+    std::string s;
+};
+
+template<typename T>
+void pushBackLoop(const std::string& name) {
+    constexpr int count = 1000000;
+    const auto before = T::Counts();
+
+    utils::Chronometer ch;
+    ch.Start();
+    {
+        std::vector<T> vec; // no reserve, reallocations move or copy the elements
+        for(int i = 0; i < count; ++i) vec.emplace_back("a string that does not fit SSO");
+    }
+    ch.Stop();
+    ch.Report(name);
+    std::cout << "    " << (T::Counts() - before) << std::endl;
+}
+
+void plainPushBackLoop() {
+    utils::Chronometer ch;
+    ch.Start();
+    {
+        std::vector<std::string> vec;
+        for(int i = 0; i < 1000000; ++i) vec.emplace_back("a string that does not fit SSO");
+    }
+    ch.Stop();
+    ch.Report("Plain std::string - ");
+}
+
+// std::vector moves elements on reallocation only if their move constructor is noexcept
+void zeroCopyTest() {
+    plainPushBackLoop(); // the first run also pays for growing the heap
+    plainPushBackLoop();
+    pushBackLoop<utils::Tracked<std::string>>("Tracked std::string - ");
+    pushBackLoop<utils::Tracked<ThrowingMoveString>>("Tracked string with throwing move - ");
+}
+
+std::atomic<std::size_t> atomicMoveCalls{0};
+utils::ShardedCounter<> shardedMoveCalls;
+
+// Every thread counts increments calls on counter, e.g. a move constructor called from many threads
+template<typename Increment>
+void runCounterThreads(int threadCount, Increment increment, const std::string& name) {
+    constexpr int increments = 10000000;
+    utils::Chronometer ch;
+    ch.Start();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&increment] {
+            for(int i = 0; i < increments; ++i) increment();
+        });
+    }
+    for(auto& th : threads) th.join();
+    ch.Stop();
+    ch.Report(name + std::to_string(threadCount) + " threads ");
+}
+
+void counterSpeedTest() {
+    const int maxThreads = std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+    for(int threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        runCounterThreads(threadCount, [] { atomicMoveCalls.fetch_add(1, std::memory_order_relaxed); }, "std::atomic counter - ");
+        runCounterThreads(threadCount, [] { ++shardedMoveCalls; }, "ShardedCounter - ");
+    }
+    std::cout << "Counted: std::atomic " << atomicMoveCalls.load() << ", ShardedCounter " << shardedMoveCalls.Load() << std::endl;
+}
+
 int main() {
 
     forwardTest();
     moveCtorTest();
+    zeroCopyTest();
+    counterSpeedTest();
 
     return 0;
 }
@@ -12,10 +12,15 @@ be eligible for the return value optimization.
 #include <iostream>
 #include <vector>
 
+#include "Tracked.h"
+
 using namespace std;
 
+// Special member calls are counted by the Tracked member, see countsSince in main
 class DummyClass {
 public:
+    using Counter = utils::Tracked<int, DummyClass>;
+
     DummyClass() : m_x(0) {};
     ~DummyClass() = default;
 
@@ -31,8 +36,8 @@ public:
         return *this;
     }
 
-    DummyClass(const DummyClass& rhs) {
-        m_x = rhs.m_x;
+    DummyClass(const DummyClass& rhs)
+    : m_x(rhs.m_x) {
         std::cout << "DummyClass copy constructor called" << std::endl;
     }
 
@@ -46,7 +51,7 @@ public:
     void dumFunc(int d) {}
 
 private:
-    int m_x;
+    Counter m_x;
 };
 
 template < typename T>
@@ -74,17 +79,31 @@ private:
     std::string m_dumString;
 };
 
+// Prints the DummyClass special member calls made since before
+void countsSince(const utils::SpecialMemberCounts& before, const std::string& step) {
+    const auto calls = DummyClass::Counter::Counts() - before;
+    std::cout << step << ": " << calls.Copies() << " copies, " << calls.Moves() << " moves" << std::endl;
+}
+
 int main() {
 
     DummyClass cls;
     Widget w1;
+    auto before = DummyClass::Counter::Counts();
     w1.setClass(cls); // cls becomes lvalue ref, calls copy assignment inside setClass func
+    countsSince(before, "setClass(lvalue)");
     Widget w2;
+    before = DummyClass::Counter::Counts();
     w2.setClass(std::move(cls)); // cls becomes rvalue ref, calls move assignment inside setClass func
+    countsSince(before, "setClass(rvalue)");
 
     DummyClass cls2;
+    before = DummyClass::Counter::Counts();
     callDum(cls2); // calls copy constructor inside callDum func
+    countsSince(before, "callDum(lvalue)");
+    before = DummyClass::Counter::Counts();
     auto cl3 = callDum(std::move(cls2)); // calls move constructor inside callDum func
+    countsSince(before, "callDum(rvalue)");
 
     std::string str = "Bart";
     w1.setString(std::move(str));
@@ -7,6 +7,11 @@ assumptions.
 
 #include <vector>
 #include <array>
+#include <deque>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <algorithm>
 #include "Chronometer.h"
 
 using namespace utils;
@@ -67,6 +72,114 @@ private:
   std::string s = "ASHFAKSDNFJASDNASHDJASDHASDJK";
 };
 
+/*
+Move cost matrix. Record<StringLength, PadBytes, NoexceptMove> is an int, a double, a string of
+StringLength characters and PadBytes of plain data; its move constructor is noexcept or not.
+Strings up to the SSO capacity (15 characters in libstdc++) live inside the string object, so
+moving them copies the characters just like a copy does; the plain data is always copied.
+*/
+template<std::size_t StringLength, std::size_t PadBytes, bool NoexceptMove>
+class Record {
+public:
+  Record() : s(StringLength, 'x') {}
+  ~Record() = default;
+
+  Record(Record&& rhs) noexcept(NoexceptMove)
+  : x(rhs.x), y(rhs.y), s(std::move(rhs.s)), pad(rhs.pad) {}
+  Record(const Record& rhs) = default;
+  Record& operator=(Record&& rhs) noexcept(NoexceptMove) {
+    x = rhs.x; y = rhs.y; s = std::move(rhs.s); pad = rhs.pad;
+    return *this;
+  }
+  Record& operator=(const Record& rhs) = default;
+
+private:
+  int x = 5;
+  double y = 10.;
+  std::string s;
+  std::array<char, PadBytes> pad{};
+};
+
+constexpr std::size_t matrixElements = 1000;
+constexpr int matrixRepetitions = 50;
+
+// Best time of matrixRepetitions runs of op, in ns per element. setup builds a fresh source, outside the timing
+template<typename Setup, typename Op>
+double bestNsPerElement(Setup setup, Op op) {
+  double best = 1e300;
+  for(int r = 0; r < matrixRepetitions; ++r) {
+    auto source = setup();
+    Chronometer ch;
+    ch.Start();
+    auto result = op(source);
+    ch.Stop();
+    (void)result; // destroyed outside the timing
+    best = std::min(best, static_cast<double>(ch.Elapsed().count()) / matrixElements);
+  }
+  return best;
+}
+
+void printMatrixRow(const char* container, std::size_t stringLength, std::size_t elementSize, bool noexceptMove, double copyNs, double moveNs) {
+  std::printf("%-14s %6zu %8zu %9s %10.2f %10.2f\n", container, stringLength, elementSize, noexceptMove ? "yes" : "no", copyNs, moveNs);
+}
+
+template<std::size_t StringLength, std::size_t PadBytes, bool NoexceptMove>
+void moveCostRows() {
+  using R = Record<StringLength, PadBytes, NoexceptMove>;
+  using Array = std::array<R, matrixElements>;
+
+  // std::array moves element by element
+  auto makeArray = [] { return std::make_unique<Array>(); };
+  printMatrixRow("array", StringLength, sizeof(R), NoexceptMove,
+    bestNsPerElement(makeArray, [](std::unique_ptr<Array>& a) { return std::make_unique<Array>(*a); }),
+    bestNsPerElement(makeArray, [](std::unique_ptr<Array>& a) { return std::make_unique<Array>(std::move(*a)); }));
+
+  // std::vector and std::deque moves steal the buffer, whatever the elements are
+  auto makeVector = [] { return std::vector<R>(matrixElements); };
+  printMatrixRow("vector", StringLength, sizeof(R), NoexceptMove,
+    bestNsPerElement(makeVector, [](std::vector<R>& v) { return std::vector<R>(v); }),
+    bestNsPerElement(makeVector, [](std::vector<R>& v) { return std::vector<R>(std::move(v)); }));
+
+  auto makeDeque = [] { return std::deque<R>(matrixElements); };
+  printMatrixRow("deque", StringLength, sizeof(R), NoexceptMove,
+    bestNsPerElement(makeDeque, [](std::deque<R>& d) { return std::deque<R>(d); }),
+    bestNsPerElement(makeDeque, [](std::deque<R>& d) { return std::deque<R>(std::move(d)); }));
+
+  // Growing a vector relocates the elements: moved only if the move constructor is noexcept, copied otherwise.
+  // The copy column forces copies for comparison
+  printMatrixRow("vector growth", StringLength, sizeof(R), NoexceptMove,
+    bestNsPerElement(makeVector, [](std::vector<R>& v) {
+      std::vector<R> grown;
+      grown.reserve(2 * v.size());
+      grown.insert(grown.end(), v.begin(), v.end());
+      return grown;
+    }),
+    bestNsPerElement(makeVector, [](std::vector<R>& v) {
+      v.reserve(2 * v.size());
+      return v.size();
+    }));
+}
+
+template<std::size_t StringLength, std::size_t PadBytes>
+void moveCostRowsBothNoexcept() {
+  moveCostRows<StringLength, PadBytes, true>();
+  moveCostRows<StringLength, PadBytes, false>();
+}
+
+void moveCostMatrix() {
+  // warm up: freeing a large block lets malloc raise its mmap threshold, so the large containers
+  // below are not mmapped and page faulted on every repetition
+  { auto warmUp = std::make_unique<std::array<Record<64, 256, false>, 4 * matrixElements>>(); }
+
+  std::printf("%-14s %6s %8s %9s %10s %10s\n", "container", "string", "element", "noexcept", "copy ns", "move ns");
+  moveCostRowsBothNoexcept<8, 0>();
+  moveCostRowsBothNoexcept<15, 0>();  // largest SSO string in libstdc++
+  moveCostRowsBothNoexcept<16, 0>();  // first heap allocated one
+  moveCostRowsBothNoexcept<64, 0>();
+  moveCostRowsBothNoexcept<8, 256>();
+  moveCostRowsBothNoexcept<64, 256>();
+}
+
 int main() {
     Chronometer ch;
 
@@ -93,5 +206,7 @@ int main() {
     ch.Stop();
     ch.Report("WidgetNoExcept move ");
 
+    moveCostMatrix();
+
     return 0;
 }
@@ -9,8 +9,21 @@ and it misleadingly suggests that lambdas are self-contained.
 #include <vector>
 #include <functional>
 #include <algorithm>
+#include <array>
+#include <string>
 
-using FuncContainer = std::vector<std::function<void(int)>>;
+#include "Chronometer.h"
+#include "InplaceFunction.h"
+#include "FunctionRef.h"
+#include "BatchDispatcher.h"
+#include "ParallelAlgorithms.h"
+#include "ThreadPool.h"
+
+// Every lambda below fits in 32 bytes, so they are stored in place, with no heap allocation.
+// A lambda capturing more does not compile:
+//     std::array<int, 16> big{};
+//     funcs.emplace_back([big](int value) {}); // static assertion: callable does not fit in inplace_function Capacity
+using FuncContainer = std::vector<utils::inplace_function<void(int), 32>>;
 
 void lambdaFuncTest() {
     std::cout << "lambdaFuncTest" << std::endl;
@@ -69,7 +82,9 @@ template<typename C>
 void workWithContainer(const C& container) {
     int divisor = 5;
 
-    if( std::all_of(std::begin(container), std::end(container),
+    // The by-reference capture is safe here: parallel_all_of returns only after every thread using
+    // the lambda is done. Small containers are checked sequentially, like std::all_of.
+    if( utils::parallel_all_of(std::begin(container), std::end(container),
         [&](const auto& value){return value % divisor == 0;})) {
         std::cout << "All of the elements are multiple of " << divisor << std::endl;
     } else {
@@ -143,11 +158,190 @@ void danglingRefTest() {
     std::cout << std::endl;
 }
 
+// A callback with 24 bytes of captures: bigger than the 16 bytes std::function stores in place in libstdc++
+struct Payload {
+    long a, b, c;
+};
+
+template<typename Function>
+void storageSpeedTest(const std::string& name) {
+    constexpr int count = 1000000;
+    utils::Chronometer ch;
+    ch.Start();
+    std::vector<Function> funcs;
+    for(int i = 0; i < count; ++i) {
+        Payload p{i, 2 * i, 3 * i};
+        funcs.emplace_back([p](int value) { return value + p.a + p.b + p.c; });
+    }
+    ch.Stop();
+    ch.Report(name + "store 1M callbacks (sizeof " + std::to_string(sizeof(Function)) + ") ");
+
+    long sum = 0;
+    ch.Start();
+    for(int round = 0; round < 50; ++round) {
+        for(auto& f : funcs) sum += f(round);
+    }
+    ch.Stop();
+    ch.Report(name + "50M calls ");
+    std::cout << "    sum " << sum << std::endl;
+}
+
+// Callback parameters. Kept out of line like a function in another translation unit would be,
+// otherwise the compiler sees the lambda through the wrapper and folds the whole loop
+#if defined(_MSC_VER)
+#define NOINLINE __declspec(noinline)
+#elif defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+NOINLINE long applyStdFunction(const std::function<long(int)>& f, int n) {
+    long sum = 0;
+    for(int i = 0; i < n; ++i) sum += f(i);
+    return sum;
+}
+
+NOINLINE long applyFunctionRef(utils::function_ref<long(int)> f, int n) {
+    long sum = 0;
+    for(int i = 0; i < n; ++i) sum += f(i);
+    return sum;
+}
+
+void callbackParameterSpeedTest() {
+    constexpr int calls = 1000;
+    constexpr int rounds = 50000;
+    utils::Chronometer ch;
+    long sum = 0;
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        Payload p{r, 2, 3};
+        sum += applyStdFunction([p](int value) { return value + p.a + p.b + p.c; }, calls); // allocates for every call
+    }
+    ch.Stop();
+    ch.Report("std::function parameter - ");
+
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        Payload p{r, 2, 3};
+        sum += applyFunctionRef([p](int value) { return value + p.a + p.b + p.c; }, calls);
+    }
+    ch.Stop();
+    ch.Report("function_ref parameter - ");
+    std::cout << "    sum " << sum << std::endl;
+}
+
+// Same callbacks over 1M values: one call per value and callback, as in lambdaFuncTest, against
+// BatchDispatcher calling each callback once per block. Both store them as inplace_function, so only
+// the batching differs
+void batchDispatchSpeedTest() {
+    constexpr std::size_t count = 1000000;
+    constexpr int rounds = 10;
+    const int divisor = 5;
+    const int offset = 7;
+
+    std::vector<int> values(count);
+    for(std::size_t i = 0; i < count; ++i) values[i] = static_cast<int>(i);
+
+    std::vector<utils::inplace_function<int(int), 32>> funcs;
+    funcs.emplace_back([](int value) { return value * 2; });
+    funcs.emplace_back([divisor](int value) { return value / divisor; });
+    funcs.emplace_back([offset](int value) { return value + offset; });
+    funcs.emplace_back([divisor, offset](int value) { return (value * 2) / divisor + offset; });
+
+    std::vector<int> perValue(funcs.size() * count);
+    utils::Chronometer ch;
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        for(std::size_t i = 0; i < count; ++i) {
+            for(std::size_t k = 0; k < funcs.size(); ++k) perValue[k * count + i] = funcs[k](values[i]);
+        }
+    }
+    ch.Stop();
+    ch.Report("Per value inplace_function calls, 10 x 1M values - ");
+
+    utils::BatchDispatcher<int, int> dispatcher;
+    dispatcher.AddPerElement([](int value) { return value * 2; }); // adapted, the loop is generated
+    dispatcher.AddPerElement([divisor](int value) { return value / divisor; });
+    dispatcher.AddPerElement([offset](int value) { return value + offset; });
+    dispatcher.AddBatch([divisor, offset](const int* in, int* out, std::size_t n) { // written for blocks
+        for(std::size_t i = 0; i < n; ++i) out[i] = (in[i] * 2) / divisor + offset;
+    });
+
+    std::vector<int> batched(dispatcher.Size() * count);
+    ch.Start();
+    for(int r = 0; r < rounds; ++r) {
+        dispatcher.Run(values.data(), count, batched.data());
+    }
+    ch.Stop();
+    ch.Report("BatchDispatcher, 10 x 1M values - ");
+    std::cout << "    same results " << (perValue == batched) << std::endl;
+}
+
+// std::all_of and std::find_if against their parallel versions over 100M ints, for a full scan and for a
+// counterexample early, in the middle and at the end of the vector
+void parallelSearchSpeedTest() {
+    constexpr std::size_t count = 100000000;
+    const int divisor = 5;
+    auto isMultiple = [divisor](int value) { return value % divisor == 0; };
+    auto isNotMultiple = [divisor](int value) { return value % divisor != 0; };
+
+    std::vector<int> values(count);
+    for(std::size_t i = 0; i < count; ++i) values[i] = static_cast<int>(i % 1000) * divisor;
+
+    utils::ThreadPool fourThreads(3); // with the calling thread
+    std::cout << "Default pool: " << utils::ThreadPool::Default().Size() << " workers" << std::endl;
+
+    const std::size_t positions[] = {count, 1000, count / 2, count - 1};
+    const char* names[] = {"no counterexample", "counterexample at 1000", "counterexample at 50M",
+                           "counterexample at 100M - 1"};
+    utils::Chronometer ch;
+    for(std::size_t p = 0; p < 4; ++p) {
+        if(positions[p] != count) values[positions[p]] = 1;
+        std::cout << names[p] << std::endl;
+
+        ch.Start();
+        bool sequential = std::all_of(values.begin(), values.end(), isMultiple);
+        ch.Stop();
+        ch.Report("    std::all_of - ");
+
+        ch.Start();
+        bool parallel = utils::parallel_all_of(values.begin(), values.end(), isMultiple);
+        ch.Stop();
+        ch.Report("    parallel_all_of, default pool - ");
+
+        ch.Start();
+        bool parallel4 = utils::parallel_all_of(values.begin(), values.end(), isMultiple, fourThreads);
+        ch.Stop();
+        ch.Report("    parallel_all_of, 4 threads - ");
+
+        ch.Start();
+        auto found = std::find_if(values.begin(), values.end(), isNotMultiple);
+        ch.Stop();
+        ch.Report("    std::find_if - ");
+
+        ch.Start();
+        auto parallelFound = utils::parallel_find_if(values.begin(), values.end(), isNotMultiple, fourThreads);
+        ch.Stop();
+        ch.Report("    parallel_find_if, 4 threads - ");
+
+        std::cout << "    same results " << (sequential == parallel && sequential == parallel4 && found == parallelFound)
+                  << std::endl;
+        if(positions[p] != count) values[positions[p]] = 0;
+    }
+}
+
 int main() {
 
     lambdaFuncTest();
     captureModeTest();
     lambdaFuncTest2();
     danglingRefTest();
+    storageSpeedTest<std::function<long(int)>>("std::function - ");
+    storageSpeedTest<utils::inplace_function<long(int), 32>>("inplace_function - ");
+    callbackParameterSpeedTest();
+    batchDispatchSpeedTest();
+    parallelSearchSpeedTest();
     return 0;
 }
@@ -0,0 +1,62 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_BATCHDISPATCHER_H_
+#define UTILS_INCLUDE_BATCHDISPATCHER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "InplaceFunction.h"
+
+namespace utils {
+
+/*
+Runs a list of callbacks over arrays of values a block at a time, instead of calling every callback
+once per value. A batch callback has the signature void(const In* in, Out* out, std::size_t count)
+(pointer and count, C++14 has no span). AddPerElement wraps an Out(In) callable in a loop, so the
+element callable is inlined into it: there is one indirect call per callback and block, and the
+loop body can be vectorised.
+Blocks of kBlockSize values keep the input block in cache while every callback reads it.
+*/
+template <typename In, typename Out, std::size_t Capacity = 32>
+class BatchDispatcher {
+ public:
+  using BatchCallback = inplace_function<void(const In*, Out*, std::size_t), Capacity>;
+
+  static constexpr std::size_t kBlockSize = 4096;
+
+  void AddBatch(BatchCallback callback) { callbacks_.push_back(std::move(callback)); }
+
+  template <typename F>
+  void AddPerElement(F f) {
+    callbacks_.emplace_back([f](const In* in, Out* out, std::size_t count) mutable {
+      for (std::size_t i = 0; i < count; ++i) {
+        out[i] = f(in[i]);
+      }
+    });
+  }
+
+  std::size_t Size() const noexcept { return callbacks_.size(); }
+
+  // out holds Size() * count values: callback k writes its results to out[k * count, (k + 1) * count)
+  void Run(const In* in, std::size_t count, Out* out) const {
+    for (std::size_t begin = 0; begin < count; begin += kBlockSize) {
+      const std::size_t n = std::min(kBlockSize, count - begin);
+      for (std::size_t k = 0; k < callbacks_.size(); ++k) {
+        callbacks_[k](in + begin, out + k * count + begin, n);
+      }
+    }
+  }
+
+ private:
+  std::vector<BatchCallback> callbacks_;
+};
+
+template <typename In, typename Out, std::size_t Capacity>
+constexpr std::size_t BatchDispatcher<In, Out, Capacity>::kBlockSize;
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_BATCHDISPATCHER_H_
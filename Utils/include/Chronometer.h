@@ -23,9 +23,12 @@ class Chronometer {
     state_ = kStopped;
     end_time_   = std::chrono::steady_clock::now();
   }
-  void Report(std::string pre= "") {
+  std::chrono::nanoseconds Elapsed() const {
     assert(kStopped == state_);
-    auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_ - start_time_);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end_time_ - start_time_);
+  }
+  void Report(std::string pre= "") {
+    auto nsecs = Elapsed();
     std::string msg = pre + "- Processing Elapsed Time:" + std::to_string(nsecs.count()) + " ns";
     std::cout << msg << std::endl;
     state_ = kFresh;
@@ -0,0 +1,96 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_COWPIMPL_H_
+#define UTILS_INCLUDE_COWPIMPL_H_
+
+#include <atomic>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/*
+Copy-on-write pimpl. Copies share one Impl through an atomic reference count, so copying is an
+increment however large Impl is. Reading goes through operator-> / operator*, which only give const
+access; Mutable() first gives the object its own Impl if it is shared (detach), then returns it.
+Copies can be read and destroyed from different threads; one object must not be mutated while it
+is being read or copied, same as any other value type.
+
+As with unique_ptr, Impl may be incomplete in the owner's header: define the owner's special member
+functions in the implementation file. A moved-from cow_pimpl is empty: it can be copied (the copy is
+empty too), assigned to and destroyed, and reading or mutating it fails an assertion.
+*/
+template <typename Impl>
+class cow_pimpl {
+  // keeps the forwarding constructor from hiding the copy constructor for non-const lvalues
+  template <typename... Args>
+  struct IsSelf : std::false_type {};
+  template <typename Arg>
+  struct IsSelf<Arg> : std::is_same<std::decay_t<Arg>, cow_pimpl> {};
+
+ public:
+  template <typename... Args, typename = std::enable_if_t<!IsSelf<Args...>::value>>
+  explicit cow_pimpl(Args&&... args) : node_(new Node(std::forward<Args>(args)...)) {}
+
+  cow_pimpl(const cow_pimpl& rhs) noexcept : node_(rhs.node_) {
+    if (node_) {
+      node_->count.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  cow_pimpl(cow_pimpl&& rhs) noexcept : node_(rhs.node_) { rhs.node_ = nullptr; }
+
+  cow_pimpl& operator=(const cow_pimpl& rhs) noexcept {
+    cow_pimpl(rhs).swap(*this);
+    return *this;
+  }
+  cow_pimpl& operator=(cow_pimpl&& rhs) noexcept {
+    cow_pimpl(std::move(rhs)).swap(*this);
+    return *this;
+  }
+
+  ~cow_pimpl() { Release(node_); }
+
+  void swap(cow_pimpl& rhs) noexcept { std::swap(node_, rhs.node_); }
+
+  const Impl& operator*() const noexcept { return *operator->(); }
+  const Impl* operator->() const noexcept {
+    assert(node_ && "cow_pimpl read after it was moved from");
+    return &node_->value;
+  }
+
+  // Copies Impl if other objects share it; the returned reference is valid until the next copy of *this
+  Impl& Mutable() {
+    assert(node_ && "cow_pimpl mutated after it was moved from");
+    // acquire pairs with the release in other owners' Release, so their last reads happened before our writes
+    if (node_->count.load(std::memory_order_acquire) != 1) {
+      Node* copy = new Node(node_->value);
+      Release(node_);
+      node_ = copy;
+    }
+    return node_->value;
+  }
+
+  // number of objects sharing the Impl, only a hint while other threads copy or destroy them
+  long use_count() const noexcept { return node_ ? node_->count.load(std::memory_order_relaxed) : 0; }
+
+ private:
+  struct Node {
+    template <typename... Args>
+    explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+    std::atomic<long> count{1};
+    Impl value;
+  };
+
+  static void Release(Node* node) noexcept {
+    if (node && node->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete node;
+    }
+  }
+
+  Node* node_;
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_COWPIMPL_H_
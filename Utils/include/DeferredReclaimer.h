@@ -0,0 +1,207 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_DEFERREDRECLAIMER_H_
+#define UTILS_INCLUDE_DEFERREDRECLAIMER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace utils {
+
+/*
+Moves object destruction off latency critical threads.
+Retire(p, deleter) pushes the pointer onto a lock-free stack and returns; a background thread
+takes everything pushed so far and runs the deleters in batches. It wakes up when batch_size
+pointers are pending, or every idle_period otherwise, so a retired object is destroyed after at
+most about idle_period even under light load.
+
+Flush() waits until everything retired before the call has been destroyed, also while another
+thread is draining. Drain() stops the background thread and destroys what is left on the calling
+thread; the destructor calls it. After Drain, Retire destroys synchronously. Drain must not run concurrently with Retire.
+Each Retire allocates one small node with new; deleters must not throw.
+*/
+class DeferredReclaimer {
+ public:
+  explicit DeferredReclaimer(std::size_t batch_size = 256,
+                             std::chrono::milliseconds idle_period = std::chrono::milliseconds(10))
+      : batch_size_(batch_size == 0 ? 1 : batch_size), idle_period_(idle_period),
+        worker_([this] { Run(); }) {}
+
+  DeferredReclaimer(const DeferredReclaimer&) = delete;
+  DeferredReclaimer& operator=(const DeferredReclaimer&) = delete;
+
+  ~DeferredReclaimer() { Drain(); }
+
+  template <typename T, typename Deleter>
+  void Retire(T* p, Deleter deleter) {
+    if (p == nullptr) {
+      return;
+    }
+    if (stopped_.load(std::memory_order_acquire)) {
+      deleter(p);
+      destroyed_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    Node* node = new NodeImpl<T, Deleter>(p, std::move(deleter));
+    // counted before it is published, so the worker never subtracts a node that was not added yet
+    const bool batch_full = pending_.fetch_add(1, std::memory_order_relaxed) + 1 == batch_size_;
+    node->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    // no lock here: a missed notification only delays the batch until the next idle_period
+    if (batch_full) {
+      wake_.notify_one();
+    }
+  }
+
+  void Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+      done_.wait(lock, [this] { return drained_; }); // Drain destroys everything
+      return;
+    }
+    const std::size_t target = passes_started_ + 1; // a pass that starts after this point sees all our pushes
+    flush_requested_ = true;
+    wake_.notify_one();
+    done_.wait(lock, [&] { return passes_done_ >= target || drained_; });
+  }
+
+  void Drain() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      stopping_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+    stopped_.store(true, std::memory_order_release);
+    ReclaimPending(); // anything pushed while the worker was finishing
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      drained_ = true;
+    }
+    done_.notify_all();
+  }
+
+  std::size_t Pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+  std::size_t Destroyed() const noexcept { return destroyed_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Node {
+    explicit Node(void (*destroy)(Node*)) : destroy(destroy) {}
+    Node* next = nullptr;
+    void (*destroy)(Node*);
+  };
+
+  template <typename T, typename Deleter>
+  struct NodeImpl : Node {
+    NodeImpl(T* p, Deleter d) : Node(&Destroy), ptr(p), deleter(std::move(d)) {}
+    static void Destroy(Node* node) noexcept {
+      auto self = static_cast<NodeImpl*>(node);
+      self->deleter(self->ptr);
+      delete self;
+    }
+    T* ptr;
+    Deleter deleter;
+  };
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+      wake_.wait_for(lock, idle_period_, [this] {
+        return stopping_ || flush_requested_ || pending_.load(std::memory_order_relaxed) >= batch_size_;
+      });
+      const std::size_t pass = ++passes_started_;
+      flush_requested_ = false;
+      lock.unlock();
+
+      ReclaimPending();
+
+      lock.lock();
+      passes_done_ = pass;
+      done_.notify_all();
+    }
+  }
+
+  void ReclaimPending() noexcept {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+    Node* oldest_first = nullptr; // destroy in retirement order
+    while (node) {
+      Node* next = node->next;
+      node->next = oldest_first;
+      oldest_first = node;
+      node = next;
+    }
+
+    std::size_t in_batch = 0;
+    while (oldest_first) {
+      Node* next = oldest_first->next;
+      oldest_first->destroy(oldest_first);
+      oldest_first = next;
+      if (++in_batch == batch_size_ || !oldest_first) {
+        pending_.fetch_sub(in_batch, std::memory_order_relaxed);
+        destroyed_.fetch_add(in_batch, std::memory_order_relaxed);
+        in_batch = 0;
+      }
+    }
+  }
+
+  const std::size_t batch_size_;
+  const std::chrono::milliseconds idle_period_;
+
+  std::atomic<Node*> head_{nullptr};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> destroyed_{0};
+  std::atomic<bool> stopped_{false};
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  bool stopping_ = false;
+  bool drained_ = false; // Drain has destroyed everything
+  bool flush_requested_ = false;
+  std::size_t passes_started_ = 0;
+  std::size_t passes_done_ = 0;
+
+  std::thread worker_; // last, so it starts after everything above is initialized
+};
+
+/*
+Deleter adapter for std::unique_ptr and std::shared_ptr: hands the pointer and the wrapped deleter
+to a DeferredReclaimer instead of destroying the object in the thread dropping the last reference.
+    std::unique_ptr<Investment, DeferredDeleter<decltype(delInvmt)>> p(raw, MakeDeferredDeleter(reclaimer, delInvmt));
+*/
+template <typename Deleter>
+class DeferredDeleter {
+ public:
+  DeferredDeleter(DeferredReclaimer& reclaimer, Deleter deleter)
+      : reclaimer_(&reclaimer), deleter_(std::move(deleter)) {}
+
+  template <typename T>
+  void operator()(T* p) const {
+    reclaimer_->Retire(p, deleter_);
+  }
+
+ private:
+  DeferredReclaimer* reclaimer_;
+  Deleter deleter_;
+};
+
+template <typename Deleter>
+DeferredDeleter<Deleter> MakeDeferredDeleter(DeferredReclaimer& reclaimer, Deleter deleter) {
+  return DeferredDeleter<Deleter>(reclaimer, std::move(deleter));
+}
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_DEFERREDRECLAIMER_H_
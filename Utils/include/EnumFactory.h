@@ -0,0 +1,77 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_ENUMFACTORY_H_
+#define UTILS_INCLUDE_ENUMFACTORY_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace utils {
+
+template <typename... Ts>
+struct TypeList {};
+
+// Creators decide how EnumFactory builds an object of type T and what it returns as Base; Make is told
+// the returned type, so a creator may deduce its return type
+struct UniqueCreator {
+  template <typename Base, typename T, typename... Args>
+  static std::unique_ptr<Base> Create(Args&&... args) {
+    return std::make_unique<T>(std::forward<Args>(args)...);
+  }
+};
+
+struct SharedCreator {
+  template <typename Base, typename T, typename... Args>
+  static std::shared_ptr<Base> Create(Args&&... args) {
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  }
+};
+
+/*
+Enum-indexed factory. The i-th type of the TypeList is created for the enumerator whose value is i,
+so the enumerators must be 0, 1, 2, ... in TypeList order, e.g.
+
+  enum class InvestmentType {Stock, Bond, RealEstate};
+  using InvestmentFactory = EnumFactory<InvestmentType, Investment, TypeList<Stock, Bond, RealEstate>>;
+  auto p = InvestmentFactory::MakeUnique(InvestmentType::Bond, 3);
+
+Other creators go through Make<Result, Creator>(type, args...), Result being what Create returns.
+For every creator and argument list a constant table of constructor thunks is built during
+compilation, so a call is a bounds check and one indirect call however many types there are.
+Values outside the table give an empty pointer, like the if/else factories.
+*/
+template <typename Enum, typename Base, typename List>
+class EnumFactory;
+
+template <typename Enum, typename Base, typename... Ts>
+class EnumFactory<Enum, Base, TypeList<Ts...>> {
+ public:
+  static constexpr std::size_t kSize = sizeof...(Ts);
+
+  template <typename Result, typename Creator, typename... Args>
+  static Result Make(Enum type, Args&&... args) {
+    using Thunk = Result (*)(Args&&...);
+    static constexpr Thunk kThunks[] = {&Creator::template Create<Base, Ts, Args...>...};
+
+    const auto index = static_cast<std::size_t>(type);
+    if (index >= kSize) {
+      return Result();
+    }
+    return kThunks[index](std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  static std::unique_ptr<Base> MakeUnique(Enum type, Args&&... args) {
+    return Make<std::unique_ptr<Base>, UniqueCreator>(type, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  static std::shared_ptr<Base> MakeShared(Enum type, Args&&... args) {
+    return Make<std::shared_ptr<Base>, SharedCreator>(type, std::forward<Args>(args)...);
+  }
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_ENUMFACTORY_H_
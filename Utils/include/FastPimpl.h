@@ -0,0 +1,71 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_FASTPIMPL_H_
+#define UTILS_INCLUDE_FASTPIMPL_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/*
+Pimpl without the heap: the Impl object lives in Size bytes of storage aligned to Align inside the
+owning class. The header only needs the two numbers, not the definition of Impl, so the compile
+firewall stays. Every member that touches Impl is a template instantiated where it is used, so like
+with std::unique_ptr the owner declares its special member functions in the header and defines them
+in the implementation file, where Impl is complete. There the destructor checks that Size and Align
+fit Impl and fails to compile otherwise. Pick a fixed budget with some headroom rather than computing
+it from Impl's members, which would bring Impl's layout back into the header, e.g.
+    utils::fast_pimpl<Impl, 8 * sizeof(void*)> pImpl;
+After a move the source holds a moved-from Impl, not an empty one.
+*/
+template <typename Impl, std::size_t Size, std::size_t Align = alignof(std::max_align_t)>
+class fast_pimpl {
+  // keeps the forwarding constructor from hiding the copy constructor for non-const lvalues
+  template <typename... Args>
+  struct IsSelf : std::false_type {};
+  template <typename Arg>
+  struct IsSelf<Arg> : std::is_same<std::decay_t<Arg>, fast_pimpl> {};
+
+ public:
+  template <typename... Args, typename = std::enable_if_t<!IsSelf<Args...>::value>>
+  explicit fast_pimpl(Args&&... args) {
+    ::new (static_cast<void*>(&storage_)) Impl(std::forward<Args>(args)...);
+  }
+
+  fast_pimpl(const fast_pimpl& rhs) { ::new (static_cast<void*>(&storage_)) Impl(*rhs); }
+  fast_pimpl(fast_pimpl&& rhs) noexcept(std::is_nothrow_move_constructible<Impl>::value) {
+    ::new (static_cast<void*>(&storage_)) Impl(std::move(*rhs));
+  }
+
+  fast_pimpl& operator=(const fast_pimpl& rhs) {
+    **this = *rhs;
+    return *this;
+  }
+  fast_pimpl& operator=(fast_pimpl&& rhs) noexcept(std::is_nothrow_move_assignable<Impl>::value) {
+    **this = std::move(*rhs);
+    return *this;
+  }
+
+  ~fast_pimpl() {
+    static_assert(sizeof(Impl) <= Size, "fast_pimpl Size is too small for Impl");
+    static_assert(Align % alignof(Impl) == 0, "fast_pimpl Align does not satisfy Impl's alignment");
+    get()->~Impl();
+  }
+
+  Impl* get() noexcept { return reinterpret_cast<Impl*>(&storage_); }
+  const Impl* get() const noexcept { return reinterpret_cast<const Impl*>(&storage_); }
+  Impl& operator*() noexcept { return *get(); }
+  const Impl& operator*() const noexcept { return *get(); }
+  Impl* operator->() noexcept { return get(); }
+  const Impl* operator->() const noexcept { return get(); }
+
+ private:
+  typename std::aligned_storage<Size, Align>::type storage_;
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_FASTPIMPL_H_
@@ -0,0 +1,70 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_FUNCTIONREF_H_
+#define UTILS_INCLUDE_FUNCTIONREF_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+template <typename Signature>
+class function_ref;
+
+/*
+Non-owning reference to a callable: an object pointer and a call thunk, two words, no allocation
+and nothing to copy. Meant for parameters, e.g. void forEach(function_ref<void(int)> f); the
+callable must outlive the function_ref, so do not store one built from a temporary lambda.
+Functions and function pointers are stored by value instead, so function_ref(&f) does not dangle.
+With a void R the result of the callable is discarded.
+*/
+template <typename R, typename... Args>
+class function_ref<R(Args...)> {
+  template <typename F>
+  using IsCompatible = std::integral_constant<
+      bool, std::is_void<R>::value || std::is_convertible<std::result_of_t<F&(Args...)>, R>::value>;
+
+ public:
+  template <typename F,
+            typename = std::enable_if_t<!std::is_same<std::decay_t<F>, function_ref>::value &&
+                                        !std::is_function<std::remove_pointer_t<std::decay_t<F>>>::value &&
+                                        IsCompatible<F>::value>>
+  function_ref(F&& f) noexcept : invoke_(&InvokeObject<std::remove_reference_t<F>>) {
+    target_.object = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+  }
+
+  template <typename F, typename = std::enable_if_t<std::is_function<F>::value && IsCompatible<F>::value>>
+  function_ref(F* f) noexcept : invoke_(&InvokeFunction<F>) {
+    target_.function = reinterpret_cast<void (*)()>(f);
+  }
+
+  function_ref(const function_ref&) noexcept = default;
+  function_ref& operator=(const function_ref&) noexcept = default;
+
+  R operator()(Args... args) const { return invoke_(target_, std::forward<Args>(args)...); }
+
+ private:
+  union Target {
+    void* object;
+    void (*function)(); // cast back to the stored function's type before calling
+  };
+
+  // the casts discard the result when R is void
+  template <typename F>
+  static R InvokeObject(Target target, Args&&... args) {
+    return static_cast<R>((*static_cast<F*>(target.object))(std::forward<Args>(args)...));
+  }
+
+  template <typename F>
+  static R InvokeFunction(Target target, Args&&... args) {
+    return static_cast<R>(reinterpret_cast<F*>(target.function)(std::forward<Args>(args)...));
+  }
+
+  Target target_;
+  R (*invoke_)(Target, Args&&...);
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_FUNCTIONREF_H_
@@ -0,0 +1,148 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_INPLACEFUNCTION_H_
+#define UTILS_INCLUDE_INPLACEFUNCTION_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+template <typename Signature, std::size_t Capacity = 32, std::size_t Alignment = alignof(std::max_align_t)>
+class inplace_function;
+
+/*
+std::function replacement that never allocates: the callable is stored in Capacity bytes inside the
+object, and a callable that does not fit, or is not nothrow movable, is a compile error instead of
+a heap allocation. Moving is noexcept, so containers of inplace_functions relocate by moving.
+Calling an empty inplace_function throws std::bad_function_call, like std::function. With a void R
+any callable taking Args is accepted and its result is discarded, also like std::function.
+*/
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Alignment>
+class inplace_function<R(Args...), Capacity, Alignment> {
+  template <typename F>
+  using EnableIfCallable = std::enable_if_t<
+      !std::is_same<std::decay_t<F>, inplace_function>::value &&
+      (std::is_void<R>::value || std::is_convertible<std::result_of_t<std::decay_t<F>&(Args...)>, R>::value)>;
+
+ public:
+  inplace_function() noexcept = default;
+  inplace_function(std::nullptr_t) noexcept {}
+
+  template <typename F, typename = EnableIfCallable<F>>
+  inplace_function(F&& f) {
+    using Stored = std::decay_t<F>;
+    static_assert(sizeof(Stored) <= Capacity, "callable does not fit in inplace_function Capacity");
+    static_assert(Alignment % alignof(Stored) == 0, "callable is over-aligned for inplace_function Alignment");
+    static_assert(std::is_nothrow_move_constructible<Stored>::value, "inplace_function needs a nothrow movable callable");
+    ::new (static_cast<void*>(&storage_)) Stored(std::forward<F>(f));
+    vtable_ = VTableFor<Stored>();
+  }
+
+  inplace_function(const inplace_function& rhs) : vtable_(rhs.vtable_) {
+    if (vtable_) {
+      vtable_->copy(&storage_, &rhs.storage_);
+    }
+  }
+
+  inplace_function(inplace_function&& rhs) noexcept : vtable_(rhs.vtable_) {
+    if (vtable_) {
+      vtable_->move(&storage_, &rhs.storage_);
+      rhs.vtable_ = nullptr;
+    }
+  }
+
+  ~inplace_function() { reset(); }
+
+  inplace_function& operator=(const inplace_function& rhs) {
+    if (this != &rhs) {
+      inplace_function copy(rhs);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  inplace_function& operator=(inplace_function&& rhs) noexcept {
+    if (this != &rhs) {
+      reset();
+      if (rhs.vtable_) {
+        rhs.vtable_->move(&storage_, &rhs.storage_);
+        vtable_ = rhs.vtable_;
+        rhs.vtable_ = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  inplace_function& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  template <typename F, typename = EnableIfCallable<F>>
+  inplace_function& operator=(F&& f) {
+    return *this = inplace_function(std::forward<F>(f));
+  }
+
+  R operator()(Args... args) const {
+    if (!vtable_) {
+      throw std::bad_function_call();
+    }
+    return vtable_->invoke(&storage_, std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+  void swap(inplace_function& rhs) noexcept {
+    inplace_function tmp(std::move(rhs));
+    rhs = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+ private:
+  using Storage = typename std::aligned_storage<Capacity, Alignment>::type;
+
+  struct VTable {
+    R (*invoke)(Storage*, Args&&...);
+    void (*copy)(Storage* dst, const Storage* src);
+    void (*move)(Storage* dst, Storage* src); // also destroys src, never throws
+    void (*destroy)(Storage*);
+  };
+
+  template <typename F>
+  struct Ops {
+    // the cast discards the result when R is void
+    static R Invoke(Storage* s, Args&&... args) { return static_cast<R>((*reinterpret_cast<F*>(s))(std::forward<Args>(args)...)); }
+    static void Copy(Storage* dst, const Storage* src) { ::new (static_cast<void*>(dst)) F(*reinterpret_cast<const F*>(src)); }
+    static void Move(Storage* dst, Storage* src) noexcept {
+      F* from = reinterpret_cast<F*>(src);
+      ::new (static_cast<void*>(dst)) F(std::move(*from));
+      from->~F();
+    }
+    static void Destroy(Storage* s) noexcept { reinterpret_cast<F*>(s)->~F(); }
+  };
+
+  // constant initialized, one table per callable type
+  template <typename F>
+  static const VTable* VTableFor() noexcept {
+    static constexpr VTable kTable = {&Ops<F>::Invoke, &Ops<F>::Copy, &Ops<F>::Move, &Ops<F>::Destroy};
+    return &kTable;
+  }
+
+  void reset() noexcept {
+    if (vtable_) {
+      vtable_->destroy(&storage_);
+      vtable_ = nullptr;
+    }
+  }
+
+  mutable Storage storage_; // the callable may be mutable state of a const inplace_function, as with std::function
+  const VTable* vtable_ = nullptr;
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_INPLACEFUNCTION_H_
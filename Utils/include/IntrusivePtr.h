@@ -0,0 +1,163 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_INTRUSIVEPTR_H_
+#define UTILS_INCLUDE_INTRUSIVEPTR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/*
+intrusive_ptr keeps a pointer to an object that carries its own reference count, so there is no
+separate control block and the pointer itself is a single word. The count is managed through the
+free functions intrusive_ptr_add_ref(p) and intrusive_ptr_release(p), found by argument dependent
+lookup, the same protocol as boost::intrusive_ptr. RefCounted below provides them.
+*/
+template <typename T>
+class intrusive_ptr {
+ public:
+  using element_type = T;
+
+  constexpr intrusive_ptr() noexcept = default;
+  constexpr intrusive_ptr(std::nullptr_t) noexcept {}
+
+  // add_ref = false adopts a reference the caller already owns, e.g. one returned by detach()
+  explicit intrusive_ptr(T* p, bool add_ref = true) noexcept : ptr_(p) {
+    if (ptr_ && add_ref) {
+      intrusive_ptr_add_ref(ptr_);
+    }
+  }
+
+  intrusive_ptr(const intrusive_ptr& rhs) noexcept : intrusive_ptr(rhs.ptr_) {}
+
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  intrusive_ptr(const intrusive_ptr<Y>& rhs) noexcept : intrusive_ptr(rhs.get()) {}
+
+  intrusive_ptr(intrusive_ptr&& rhs) noexcept : ptr_(rhs.ptr_) { rhs.ptr_ = nullptr; }
+
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  intrusive_ptr(intrusive_ptr<Y>&& rhs) noexcept : ptr_(rhs.detach()) {}
+
+  ~intrusive_ptr() {
+    if (ptr_) {
+      intrusive_ptr_release(ptr_);
+    }
+  }
+
+  intrusive_ptr& operator=(const intrusive_ptr& rhs) noexcept {
+    intrusive_ptr(rhs).swap(*this);
+    return *this;
+  }
+  intrusive_ptr& operator=(intrusive_ptr&& rhs) noexcept {
+    intrusive_ptr(std::move(rhs)).swap(*this);
+    return *this;
+  }
+  template <typename Y>
+  intrusive_ptr& operator=(const intrusive_ptr<Y>& rhs) noexcept {
+    intrusive_ptr(rhs).swap(*this);
+    return *this;
+  }
+  template <typename Y>
+  intrusive_ptr& operator=(intrusive_ptr<Y>&& rhs) noexcept {
+    intrusive_ptr(std::move(rhs)).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept { intrusive_ptr().swap(*this); }
+  void reset(T* p, bool add_ref = true) noexcept { intrusive_ptr(p, add_ref).swap(*this); }
+
+  // gives up ownership without releasing the reference
+  T* detach() noexcept {
+    T* p = ptr_;
+    ptr_ = nullptr;
+    return p;
+  }
+
+  void swap(intrusive_ptr& rhs) noexcept { std::swap(ptr_, rhs.ptr_); }
+
+  T* get() const noexcept { return ptr_; }
+  T& operator*() const noexcept { return *ptr_; }
+  T* operator->() const noexcept { return ptr_; }
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+ private:
+  T* ptr_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept { return lhs.get() == rhs.get(); }
+template <typename T, typename U>
+bool operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept { return lhs.get() != rhs.get(); }
+template <typename T>
+bool operator==(const intrusive_ptr<T>& lhs, std::nullptr_t) noexcept { return !lhs; }
+template <typename T>
+bool operator!=(const intrusive_ptr<T>& lhs, std::nullptr_t) noexcept { return static_cast<bool>(lhs); }
+
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args&&... args) {
+  return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+// Count policies: Increment, Decrement (returns the new count) and Load.
+// AtomicRefCount can be shared between threads, LocalRefCount must stay on one thread.
+class AtomicRefCount {
+ public:
+  void Increment() noexcept { count_.fetch_add(1, std::memory_order_relaxed); }
+  // acq_rel so that the thread releasing the last reference sees every write made through other references
+  int Decrement() noexcept { return count_.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+  int Load() const noexcept { return count_.load(std::memory_order_relaxed); }
+ private:
+  std::atomic<int> count_{0};
+};
+
+class LocalRefCount {
+ public:
+  void Increment() noexcept { ++count_; }
+  int Decrement() noexcept { return --count_; }
+  int Load() const noexcept { return count_; }
+ private:
+  int count_ = 0;
+};
+
+// Release hook called when the last reference goes away. Any type with a static Release(const T*) works,
+// e.g. one that destroys the object and returns its memory to a pool.
+struct DeleteRelease {
+  template <typename T>
+  static void Release(const T* p) noexcept { delete p; }
+};
+
+/*
+Embeddable reference count. Derive as class Investment : public RefCounted<Investment, ...>.
+Derived is the type handed to ReleasePolicy, so for a hierarchy use the root class and give it a
+virtual destructor. Copying an object does not copy its count: the copy starts unreferenced.
+*/
+template <typename Derived, typename CountPolicy = AtomicRefCount, typename ReleasePolicy = DeleteRelease>
+class RefCounted {
+ public:
+  int use_count() const noexcept { return ref_count_.Load(); }
+
+  friend void intrusive_ptr_add_ref(const Derived* p) noexcept {
+    static_cast<const RefCounted*>(p)->ref_count_.Increment();
+  }
+  friend void intrusive_ptr_release(const Derived* p) noexcept {
+    if (static_cast<const RefCounted*>(p)->ref_count_.Decrement() == 0) {
+      ReleasePolicy::Release(p);
+    }
+  }
+
+ protected:
+  RefCounted() noexcept = default;
+  RefCounted(const RefCounted&) noexcept {}
+  RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+  ~RefCounted() = default;
+
+ private:
+  mutable CountPolicy ref_count_;
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_INTRUSIVEPTR_H_
@@ -0,0 +1,381 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_LOCALSHAREDPTR_H_
+#define UTILS_INCLUDE_LOCALSHAREDPTR_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+/*
+local_shared_ptr / local_weak_ptr have the shape of std::shared_ptr / std::weak_ptr, but their
+reference counts are plain integers instead of atomics. Every copy of a given pointer, and every
+weak pointer observing it, must therefore be used by a single thread only.
+
+Supported: make_local_shared, allocate_local_shared, custom deleters and allocators, conversion from
+local_shared_ptr<Derived> and from std::unique_ptr, weak references with lock()/expired().
+Not supported: aliasing constructor, owner_before and shared_from_this.
+*/
+
+template <typename T> class local_shared_ptr;
+template <typename T> class local_weak_ptr;
+
+namespace detail {
+
+class LocalControlBlock {
+ public:
+  LocalControlBlock() = default;
+  LocalControlBlock(const LocalControlBlock&) = delete;
+  LocalControlBlock& operator=(const LocalControlBlock&) = delete;
+
+  void AddUse() noexcept { ++uses_; }
+  void AddWeak() noexcept { ++weaks_; }
+  bool TryAddUse() noexcept {
+    if (uses_ == 0) {
+      return false;
+    }
+    ++uses_;
+    return true;
+  }
+  void ReleaseUse() noexcept {
+    if (--uses_ == 0) {
+      Dispose();
+      ReleaseWeak(); // all uses together hold one weak count
+    }
+  }
+  void ReleaseWeak() noexcept {
+    if (--weaks_ == 0) {
+      Destroy();
+    }
+  }
+  long UseCount() const noexcept { return uses_; }
+
+ protected:
+  ~LocalControlBlock() = default;
+
+ private:
+  virtual void Dispose() noexcept = 0; // destroys the managed object
+  virtual void Destroy() noexcept = 0; // frees the control block itself
+
+  long uses_ = 1;
+  long weaks_ = 1;
+};
+
+template <typename Block, typename Alloc>
+using ReboundAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+
+// control block for a pointer handed over by the user, with its deleter
+template <typename P, typename D, typename Alloc>
+class LocalPtrBlock final : public LocalControlBlock {
+ public:
+  // d is moved from only once nothing else can throw, so the caller can still use it if this throws
+  LocalPtrBlock(P p, D&& d, const Alloc& a) : ptr_(p), alloc_(a), deleter_(std::move(d)) {}
+
+ private:
+  void Dispose() noexcept override { deleter_(ptr_); }
+  void Destroy() noexcept override {
+    ReboundAlloc<LocalPtrBlock, Alloc> alloc(alloc_);
+    this->~LocalPtrBlock();
+    std::allocator_traits<decltype(alloc)>::deallocate(alloc, this, 1);
+  }
+
+  P ptr_;
+  Alloc alloc_;
+  D deleter_;
+};
+
+// control block with the object in place, used by make_local_shared and allocate_local_shared
+template <typename T, typename Alloc>
+class LocalInplaceBlock final : public LocalControlBlock {
+ public:
+  template <typename... Args>
+  LocalInplaceBlock(const Alloc& a, Args&&... args) : alloc_(a) {
+    ::new (static_cast<void*>(&storage_)) T(std::forward<Args>(args)...);
+  }
+
+  T* Get() noexcept { return reinterpret_cast<T*>(&storage_); }
+
+ private:
+  void Dispose() noexcept override { Get()->~T(); }
+  void Destroy() noexcept override {
+    ReboundAlloc<LocalInplaceBlock, Alloc> alloc(alloc_);
+    this->~LocalInplaceBlock();
+    std::allocator_traits<decltype(alloc)>::deallocate(alloc, this, 1);
+  }
+
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+  Alloc alloc_;
+};
+
+} // namespace detail
+
+template <typename T>
+class local_shared_ptr {
+ public:
+  using element_type = T;
+  using weak_type = local_weak_ptr<T>;
+
+  constexpr local_shared_ptr() noexcept = default;
+  constexpr local_shared_ptr(std::nullptr_t) noexcept {}
+
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  explicit local_shared_ptr(Y* p) : local_shared_ptr(p, std::default_delete<Y>()) {}
+
+  template <typename Y, typename D, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_shared_ptr(Y* p, D d) : ptr_(p) {
+    Init(p, d, std::allocator<Y>());
+  }
+
+  template <typename Y, typename D, typename A, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_shared_ptr(Y* p, D d, A a) : ptr_(p) {
+    Init(p, d, a);
+  }
+
+  // up keeps ownership if the control block cannot be created
+  template <typename Y, typename D, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_shared_ptr(std::unique_ptr<Y, D>&& up) {
+    if (!up) {
+      return;
+    }
+    using Deleter = std::remove_reference_t<D>;
+    using Block = detail::LocalPtrBlock<Y*, Deleter, std::allocator<Y>>;
+    std::allocator<Block> alloc;
+    Block* block = alloc.allocate(1);
+    try {
+      ::new (static_cast<void*>(block)) Block(up.get(), Deleter(up.get_deleter()), std::allocator<Y>());
+    } catch (...) {
+      alloc.deallocate(block, 1);
+      throw;
+    }
+    ptr_ = up.release();
+    block_ = block;
+  }
+
+  local_shared_ptr(const local_shared_ptr& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    if (block_) {
+      block_->AddUse();
+    }
+  }
+
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_shared_ptr(const local_shared_ptr<Y>& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    if (block_) {
+      block_->AddUse();
+    }
+  }
+
+  local_shared_ptr(local_shared_ptr&& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    rhs.ptr_ = nullptr;
+    rhs.block_ = nullptr;
+  }
+
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_shared_ptr(local_shared_ptr<Y>&& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    rhs.ptr_ = nullptr;
+    rhs.block_ = nullptr;
+  }
+
+  // throws std::bad_weak_ptr if rhs has expired, like std::shared_ptr
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  explicit local_shared_ptr(const local_weak_ptr<Y>& rhs) {
+    if (!rhs.block_ || !rhs.block_->TryAddUse()) {
+      throw std::bad_weak_ptr();
+    }
+    ptr_ = rhs.ptr_;
+    block_ = rhs.block_;
+  }
+
+  ~local_shared_ptr() {
+    if (block_) {
+      block_->ReleaseUse();
+    }
+  }
+
+  local_shared_ptr& operator=(const local_shared_ptr& rhs) noexcept {
+    local_shared_ptr(rhs).swap(*this);
+    return *this;
+  }
+  local_shared_ptr& operator=(local_shared_ptr&& rhs) noexcept {
+    local_shared_ptr(std::move(rhs)).swap(*this);
+    return *this;
+  }
+  template <typename Y>
+  local_shared_ptr& operator=(const local_shared_ptr<Y>& rhs) noexcept {
+    local_shared_ptr(rhs).swap(*this);
+    return *this;
+  }
+  template <typename Y>
+  local_shared_ptr& operator=(local_shared_ptr<Y>&& rhs) noexcept {
+    local_shared_ptr(std::move(rhs)).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept { local_shared_ptr().swap(*this); }
+  template <typename Y>
+  void reset(Y* p) { local_shared_ptr(p).swap(*this); }
+  template <typename Y, typename D>
+  void reset(Y* p, D d) { local_shared_ptr(p, std::move(d)).swap(*this); }
+  template <typename Y, typename D, typename A>
+  void reset(Y* p, D d, A a) { local_shared_ptr(p, std::move(d), std::move(a)).swap(*this); }
+
+  void swap(local_shared_ptr& rhs) noexcept {
+    std::swap(ptr_, rhs.ptr_);
+    std::swap(block_, rhs.block_);
+  }
+
+  T* get() const noexcept { return ptr_; }
+  T& operator*() const noexcept { return *ptr_; }
+  T* operator->() const noexcept { return ptr_; }
+  long use_count() const noexcept { return block_ ? block_->UseCount() : 0; }
+  explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+ private:
+  template <typename Y> friend class local_shared_ptr;
+  template <typename Y> friend class local_weak_ptr;
+  template <typename Y, typename A, typename... Args>
+  friend local_shared_ptr<Y> allocate_local_shared(const A& a, Args&&... args);
+
+  // like std::shared_ptr, d(p) is called if the control block cannot be created
+  template <typename Y, typename D, typename A>
+  void Init(Y* p, D& d, const A& a) {
+    using Block = detail::LocalPtrBlock<Y*, D, A>;
+    detail::ReboundAlloc<Block, A> alloc(a);
+    Block* block = nullptr;
+    try {
+      block = std::allocator_traits<decltype(alloc)>::allocate(alloc, 1);
+      ::new (static_cast<void*>(block)) Block(p, std::move(d), a);
+    } catch (...) {
+      if (block) {
+        std::allocator_traits<decltype(alloc)>::deallocate(alloc, block, 1);
+      }
+      d(p);
+      throw;
+    }
+    block_ = block;
+  }
+
+  T* ptr_ = nullptr;
+  detail::LocalControlBlock* block_ = nullptr;
+};
+
+template <typename T>
+class local_weak_ptr {
+ public:
+  constexpr local_weak_ptr() noexcept = default;
+
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_weak_ptr(const local_shared_ptr<Y>& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    if (block_) {
+      block_->AddWeak();
+    }
+  }
+
+  local_weak_ptr(const local_weak_ptr& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    if (block_) {
+      block_->AddWeak();
+    }
+  }
+
+  // Converting Y* to T* may read the object (through a virtual base), so the pointer is only taken
+  // while the object is alive; an expired rhs gives an expired pointer with no address, as lock() would
+  template <typename Y, typename = std::enable_if_t<std::is_convertible<Y*, T*>::value>>
+  local_weak_ptr(const local_weak_ptr<Y>& rhs) noexcept : block_(rhs.block_) {
+    if (block_) {
+      block_->AddWeak();
+      if (block_->UseCount() != 0) {
+        ptr_ = rhs.ptr_;
+      }
+    }
+  }
+
+  local_weak_ptr(local_weak_ptr&& rhs) noexcept : ptr_(rhs.ptr_), block_(rhs.block_) {
+    rhs.ptr_ = nullptr;
+    rhs.block_ = nullptr;
+  }
+
+  ~local_weak_ptr() {
+    if (block_) {
+      block_->ReleaseWeak();
+    }
+  }
+
+  local_weak_ptr& operator=(const local_weak_ptr& rhs) noexcept {
+    local_weak_ptr(rhs).swap(*this);
+    return *this;
+  }
+  local_weak_ptr& operator=(local_weak_ptr&& rhs) noexcept {
+    local_weak_ptr(std::move(rhs)).swap(*this);
+    return *this;
+  }
+  template <typename Y>
+  local_weak_ptr& operator=(const local_shared_ptr<Y>& rhs) noexcept {
+    local_weak_ptr(rhs).swap(*this);
+    return *this;
+  }
+
+  void reset() noexcept { local_weak_ptr().swap(*this); }
+  void swap(local_weak_ptr& rhs) noexcept {
+    std::swap(ptr_, rhs.ptr_);
+    std::swap(block_, rhs.block_);
+  }
+
+  long use_count() const noexcept { return block_ ? block_->UseCount() : 0; }
+  bool expired() const noexcept { return use_count() == 0; }
+
+  local_shared_ptr<T> lock() const noexcept {
+    local_shared_ptr<T> result;
+    if (block_ && block_->TryAddUse()) {
+      result.ptr_ = ptr_;
+      result.block_ = block_;
+    }
+    return result;
+  }
+
+ private:
+  template <typename Y> friend class local_shared_ptr;
+  template <typename Y> friend class local_weak_ptr;
+
+  T* ptr_ = nullptr;
+  detail::LocalControlBlock* block_ = nullptr;
+};
+
+// one allocation for the object and its control block, like std::allocate_shared
+template <typename T, typename A, typename... Args>
+local_shared_ptr<T> allocate_local_shared(const A& a, Args&&... args) {
+  using Block = detail::LocalInplaceBlock<T, A>;
+  detail::ReboundAlloc<Block, A> alloc(a);
+  Block* block = std::allocator_traits<decltype(alloc)>::allocate(alloc, 1);
+  try {
+    ::new (static_cast<void*>(block)) Block(a, std::forward<Args>(args)...);
+  } catch (...) {
+    std::allocator_traits<decltype(alloc)>::deallocate(alloc, block, 1);
+    throw;
+  }
+
+  local_shared_ptr<T> result;
+  result.ptr_ = block->Get();
+  result.block_ = block;
+  return result;
+}
+
+template <typename T, typename... Args>
+local_shared_ptr<T> make_local_shared(Args&&... args) {
+  return allocate_local_shared<T>(std::allocator<T>(), std::forward<Args>(args)...);
+}
+
+template <typename T, typename U>
+bool operator==(const local_shared_ptr<T>& lhs, const local_shared_ptr<U>& rhs) noexcept { return lhs.get() == rhs.get(); }
+template <typename T, typename U>
+bool operator!=(const local_shared_ptr<T>& lhs, const local_shared_ptr<U>& rhs) noexcept { return lhs.get() != rhs.get(); }
+template <typename T>
+bool operator==(const local_shared_ptr<T>& lhs, std::nullptr_t) noexcept { return !lhs; }
+template <typename T>
+bool operator!=(const local_shared_ptr<T>& lhs, std::nullptr_t) noexcept { return static_cast<bool>(lhs); }
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_LOCALSHAREDPTR_H_
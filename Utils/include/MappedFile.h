@@ -0,0 +1,98 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_MAPPEDFILE_H_
+#define UTILS_INCLUDE_MAPPEDFILE_H_
+
+// POSIX only: elsewhere this header is empty and UTILS_HAS_MAPPED_FILE is not defined
+#if defined(__unix__) || defined(__APPLE__)
+
+#define UTILS_HAS_MAPPED_FILE 1
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils {
+
+/*
+Read-only memory mapping of a whole file (POSIX). Nothing is read when the file is mapped: each page
+is brought in by the kernel the first time it is touched and stays in the page cache, so objects
+laid out in the file can be used in place without copying them. Throws std::system_error when the
+file cannot be opened or mapped.
+*/
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "fstat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "mmap " + path);
+      }
+      data_ = static_cast<const unsigned char*>(data);
+    }
+    ::close(fd); // the mapping keeps the file referenced
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() {
+    if (data_) {
+      ::munmap(const_cast<unsigned char*>(data_), size_);
+    }
+  }
+
+  const unsigned char* Data() const noexcept { return data_; }
+  std::size_t Size() const noexcept { return size_; }
+
+  // Turns off read-ahead, for lookups that jump around the file
+  void AdviseRandom() const noexcept {
+    if (data_) {
+      ::madvise(const_cast<unsigned char*>(data_), size_, MADV_RANDOM);
+    }
+  }
+
+  // Asks the kernel to evict the file's clean pages from the page cache, so that the next access
+  // reads from the disk again. Used to measure cold loads; it is only a hint.
+  // Does nothing where posix_fadvise is missing (macOS).
+  static void DropPageCache(const std::string& path) noexcept {
+#ifdef POSIX_FADV_DONTNEED
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+  }
+
+ private:
+  const unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+} // namespace utils
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif //UTILS_INCLUDE_MAPPEDFILE_H_
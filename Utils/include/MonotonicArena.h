@@ -0,0 +1,148 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_MONOTONICARENA_H_
+#define UTILS_INCLUDE_MONOTONICARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace utils {
+
+/*
+Monotonic arena: allocation bumps a pointer inside the current block, deallocation does nothing.
+Blocks come from ::operator new and grow geometrically up to kMaxBlockSize, so n allocations cost
+O(log n) heap calls. Memory is given back in bulk: Reset() rewinds to the first block and keeps all
+blocks for the next round, Release() and the destructor return them to the system.
+Everything allocated from the arena must be destroyed before Reset or Release. Not thread safe.
+*/
+class MonotonicArena {
+ public:
+  static constexpr std::size_t kMaxBlockSize = 16 * 1024 * 1024;
+
+  explicit MonotonicArena(std::size_t initial_block_size = 4096)
+      : next_block_size_(initial_block_size == 0 ? 1 : initial_block_size) {}
+
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+  ~MonotonicArena() { Release(); }
+
+  // alignment must be a power of two
+  void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+    for (;;) {
+      if (current_ < blocks_.size()) {
+        const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(blocks_[current_].data);
+        const std::uintptr_t aligned = (begin + used_ + alignment - 1) & ~(alignment - 1);
+        if (aligned + size <= begin + blocks_[current_].size) {
+          used_ = aligned + size - begin;
+          return reinterpret_cast<void*>(aligned);
+        }
+        if (current_ + 1 < blocks_.size() && blocks_[current_ + 1].size >= size + alignment) {
+          ++current_; // reuse a block kept by Reset
+          used_ = 0;
+          continue;
+        }
+      }
+      AddBlock(size + alignment);
+    }
+  }
+
+  // Rewinds to the first block, all blocks are kept for reuse
+  void Reset() noexcept {
+    current_ = 0;
+    used_ = 0;
+  }
+
+  // Returns every block to the system
+  void Release() noexcept {
+    for (auto& block : blocks_) {
+      ::operator delete(block.data);
+    }
+    blocks_.clear();
+    current_ = 0;
+    used_ = 0;
+  }
+
+  // number of blocks taken from ::operator new since construction
+  std::size_t BlockAllocations() const noexcept { return block_allocations_; }
+
+  std::size_t Capacity() const noexcept {
+    std::size_t capacity = 0;
+    for (auto& block : blocks_) {
+      capacity += block.size;
+    }
+    return capacity;
+  }
+
+ private:
+  struct Block {
+    void* data;
+    std::size_t size;
+  };
+
+  // inserts a block after the current one, so the blocks kept by Reset that follow stay usable
+  void AddBlock(std::size_t min_size) {
+    std::size_t size = next_block_size_;
+    while (size < min_size) {
+      size *= 2;
+    }
+    if (next_block_size_ < kMaxBlockSize) {
+      next_block_size_ *= 2;
+    }
+    Block block{::operator new(size), size};
+    ++block_allocations_;
+
+    const std::size_t position = blocks_.empty() ? 0 : current_ + 1;
+    try {
+      blocks_.insert(blocks_.begin() + position, block);
+    } catch (...) {
+      ::operator delete(block.data);
+      throw;
+    }
+    current_ = position;
+    used_ = 0;
+  }
+
+  std::vector<Block> blocks_;
+  std::size_t current_ = 0; // block allocations are made from
+  std::size_t used_ = 0;    // bytes used in the current block
+  std::size_t next_block_size_;
+  std::size_t block_allocations_ = 0;
+};
+
+/*
+Standard allocator drawing from a MonotonicArena, for std::allocate_shared and containers:
+    auto p = std::allocate_shared<Widget>(ArenaAllocator<Widget>(arena), 3);
+    std::vector<int, ArenaAllocator<int>> v(ArenaAllocator<int>(arena));
+deallocate is a no-op, the memory comes back when the arena is reset.
+*/
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(MonotonicArena& arena) noexcept : arena_(&arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& rhs) noexcept : arena_(rhs.arena()) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T*, std::size_t) noexcept {}
+
+  MonotonicArena* arena() const noexcept { return arena_; }
+
+ private:
+  MonotonicArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept { return lhs.arena() == rhs.arena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept { return lhs.arena() != rhs.arena(); }
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_MONOTONICARENA_H_
@@ -0,0 +1,164 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_PARALLELALGORITHMS_H_
+#define UTILS_INCLUDE_PARALLELALGORITHMS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+
+#include "ThreadPool.h"
+
+namespace utils {
+
+namespace detail {
+
+constexpr std::size_t kSearchBlockSize = 1024; // elements tested between two cancellation checks
+// Handing chunks to the pool costs tens of microseconds, a sequential scan of this many elements with
+// a cheap predicate takes a few hundred. Not tuned for machines with many cores.
+constexpr std::size_t kParallelSearchThreshold = 1 << 18;
+constexpr std::size_t kMinSearchChunkSize = 1 << 16;
+
+// Shared by the calling thread and its helpers; lives on the caller's stack until every helper is done.
+struct SearchState {
+  explicit SearchState(std::size_t n) : found(n) {}
+
+  std::atomic<std::size_t> next_chunk{0};
+  std::atomic<std::size_t> found; // lowest matching index seen so far, n while there is none
+  std::mutex mutex;
+  std::condition_variable done;
+  std::size_t running_helpers = 0;
+  std::exception_ptr error; // first exception thrown by pred, guarded by mutex
+};
+
+/*
+Chunks are claimed in increasing order, so once a match is known every chunk still unclaimed starts
+after it and is skipped; chunks in progress stop at their next block. With first_match false any match
+ends the search, with first_match true only the chunks after the lowest match so far are cancelled.
+*/
+template <typename RandomIt, typename Pred>
+void SearchChunks(RandomIt first, std::size_t n, std::size_t chunk_size, bool first_match, SearchState& state,
+                  Pred& pred) {
+  const std::size_t chunks = (n + chunk_size - 1) / chunk_size;
+  for (;;) {
+    const std::size_t chunk = state.next_chunk.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= chunks) {
+      return;
+    }
+    const std::size_t chunk_begin = chunk * chunk_size;
+    const std::size_t chunk_end = std::min(chunk_begin + chunk_size, n);
+    for (std::size_t block = chunk_begin; block < chunk_end; block += kSearchBlockSize) {
+      const std::size_t found = state.found.load(std::memory_order_relaxed);
+      if (first_match ? found < block : found != n) {
+        return;
+      }
+      const std::size_t block_end = std::min(block + kSearchBlockSize, chunk_end);
+      const std::size_t index = static_cast<std::size_t>(std::find_if(first + block, first + block_end, std::ref(pred)) - first);
+      if (index != block_end) {
+        std::size_t current = state.found.load(std::memory_order_relaxed);
+        while (index < current &&
+               !state.found.compare_exchange_weak(current, index, std::memory_order_relaxed)) {
+        }
+        break;
+      }
+    }
+  }
+}
+
+// SearchChunks that stores the exception of pred in state and cancels the search instead of throwing
+template <typename RandomIt, typename Pred>
+void SearchChunksNoThrow(RandomIt first, std::size_t n, std::size_t chunk_size, bool first_match,
+                         SearchState& state, Pred& pred) noexcept {
+  try {
+    SearchChunks(first, n, chunk_size, first_match, state, pred);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.error) {
+      state.error = std::current_exception();
+    }
+    state.found.store(0, std::memory_order_relaxed); // below every block: all threads stop
+  }
+}
+
+// Index of the first match (first_match) or of any match, n if there is none
+template <typename RandomIt, typename Pred>
+std::size_t FindIndex(RandomIt first, std::size_t n, Pred& pred, bool first_match, ThreadPool& pool) {
+  if (n < kParallelSearchThreshold || pool.Size() == 0) {
+    return static_cast<std::size_t>(std::find_if(first, first + n, std::ref(pred)) - first);
+  }
+
+  // a few chunks per thread balance uneven predicates; more only add claims and cancellation latency
+  const std::size_t threads = pool.Size() + 1;
+  const std::size_t chunk_size = std::max(kMinSearchChunkSize, n / (threads * 4));
+  const std::size_t helpers = std::min(pool.Size(), (n + chunk_size - 1) / chunk_size - 1);
+
+  SearchState state(n);
+  state.running_helpers = helpers;
+  std::size_t submitted = 0;
+  try {
+    for (; submitted < helpers; ++submitted) {
+      pool.Submit([first, n, chunk_size, first_match, &state, pred]() mutable {
+        SearchChunksNoThrow(first, n, chunk_size, first_match, state, pred);
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (--state.running_helpers == 0) {
+          state.done.notify_one();
+        }
+      });
+    }
+  } catch (...) { // copying pred or queueing the task failed: search with the helpers already started
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.running_helpers -= helpers - submitted;
+  }
+  SearchChunksNoThrow(first, n, chunk_size, first_match, state, pred);
+
+  // the helpers use state and pred until they are done, also when pred threw
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.done.wait(lock, [&state] { return state.running_helpers == 0; });
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+  return state.found.load(std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+/*
+Parallel counterparts of std::find_if, all_of, any_of and none_of for random access ranges.
+Large ranges are split in chunks searched by the calling thread and the workers of pool, and the
+first counterexample cancels the chunks not yet searched, so an early exit stays cheap. Ranges below
+kParallelSearchThreshold elements, or a pool without workers, are searched by std::find_if on the
+calling thread.
+pred is copied to every thread and called concurrently, so it must not modify shared state. If it
+throws, the search stops, the caller waits for the helpers and rethrows the first exception.
+Do not call these from a task running on the same pool: the caller waits for its helpers.
+*/
+template <typename RandomIt, typename Pred>
+RandomIt parallel_find_if(RandomIt first, RandomIt last, Pred pred, ThreadPool& pool = ThreadPool::Default()) {
+  const auto n = static_cast<std::size_t>(std::distance(first, last));
+  return first + detail::FindIndex(first, n, pred, true, pool);
+}
+
+template <typename RandomIt, typename Pred>
+bool parallel_any_of(RandomIt first, RandomIt last, Pred pred, ThreadPool& pool = ThreadPool::Default()) {
+  const auto n = static_cast<std::size_t>(std::distance(first, last));
+  return detail::FindIndex(first, n, pred, false, pool) != n;
+}
+
+template <typename RandomIt, typename Pred>
+bool parallel_none_of(RandomIt first, RandomIt last, Pred pred, ThreadPool& pool = ThreadPool::Default()) {
+  return !parallel_any_of(first, last, pred, pool);
+}
+
+template <typename RandomIt, typename Pred>
+bool parallel_all_of(RandomIt first, RandomIt last, Pred pred, ThreadPool& pool = ThreadPool::Default()) {
+  return parallel_none_of(first, last, [pred](const auto& value) mutable { return !pred(value); }, pool);
+}
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_PARALLELALGORITHMS_H_
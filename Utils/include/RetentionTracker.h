@@ -0,0 +1,164 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_RETENTIONTRACKER_H_
+#define UTILS_INCLUDE_RETENTIONTRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// "file:line" of the place it is written at, as a string literal
+#define UTILS_STRINGIFY_IMPL(x) #x
+#define UTILS_STRINGIFY(x) UTILS_STRINGIFY_IMPL(x)
+#define UTILS_ALLOCATION_SITE __FILE__ ":" UTILS_STRINGIFY(__LINE__)
+
+namespace utils {
+
+/*
+Diagnostic for memory that std::weak_ptrs keep alive. allocate_shared puts the object and its control
+block in one allocation, which is destroyed when the last shared_ptr goes but freed only when the
+last weak_ptr goes. Blocks allocated through a RetentionAllocator are recorded here: an allocator
+destroy() on an object inside a block marks it as retained, deallocate() forgets it. Report() sums
+the live and retained blocks per allocation site.
+Meant for debugging: every call takes a mutex and an ordered map lookup.
+*/
+class RetentionTracker {
+ public:
+  struct SiteReport {
+    std::string site;
+    std::size_t live_blocks = 0;
+    std::size_t live_bytes = 0;
+    std::size_t retained_blocks = 0; // object destroyed, memory still held by weak_ptrs
+    std::size_t retained_bytes = 0;
+  };
+
+  void OnAllocate(const void* block, std::size_t bytes, const char* site) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_[Address(block)] = Block{bytes, site, false};
+  }
+
+  void OnDeallocate(const void* block) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_.erase(Address(block));
+  }
+
+  // called with the address of an object that was constructed inside a tracked block
+  void OnDestroy(const void* object) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = blocks_.upper_bound(Address(object));
+    if (it == blocks_.begin()) {
+      return;
+    }
+    --it;
+    if (Address(object) < it->first + it->second.bytes) {
+      it->second.object_destroyed = true;
+    }
+  }
+
+  std::vector<SiteReport> Report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<const char*, SiteReport> sites; // sites are string literals, compared by address
+    for (auto& entry : blocks_) {
+      const Block& block = entry.second;
+      SiteReport& report = sites[block.site];
+      report.site = block.site;
+      if (block.object_destroyed) {
+        ++report.retained_blocks;
+        report.retained_bytes += block.bytes;
+      } else {
+        ++report.live_blocks;
+        report.live_bytes += block.bytes;
+      }
+    }
+    std::vector<SiteReport> reports;
+    for (auto& site : sites) {
+      reports.push_back(std::move(site.second));
+    }
+    return reports;
+  }
+
+  void Print(std::ostream& os) const {
+    for (auto& report : Report()) {
+      os << report.site << ": " << report.live_blocks << " live blocks (" << report.live_bytes << " bytes), "
+         << report.retained_blocks << " retained by weak_ptrs only (" << report.retained_bytes << " bytes)\n";
+    }
+  }
+
+ private:
+  struct Block {
+    std::size_t bytes;
+    const char* site;
+    bool object_destroyed;
+  };
+
+  static std::uintptr_t Address(const void* p) noexcept { return reinterpret_cast<std::uintptr_t>(p); }
+
+  mutable std::mutex mutex_;
+  std::map<std::uintptr_t, Block> blocks_;
+};
+
+/*
+Allocator that reports to a RetentionTracker, for std::allocate_shared:
+    auto p = std::allocate_shared<Widget>(RetentionAllocator<Widget>(tracker, UTILS_ALLOCATION_SITE), id);
+The control block allocator destroys the object through destroy() when the strong count drops to
+zero and frees the block through deallocate() when the weak count does, which is what makes the
+retained time visible. site must outlive the tracker, normally it is a string literal.
+*/
+template <typename T>
+class RetentionAllocator {
+ public:
+  using value_type = T;
+
+  RetentionAllocator(RetentionTracker& tracker, const char* site) noexcept : tracker_(&tracker), site_(site) {}
+  template <typename U>
+  RetentionAllocator(const RetentionAllocator<U>& rhs) noexcept : tracker_(rhs.tracker()), site_(rhs.site()) {}
+
+  T* allocate(std::size_t n) {
+    T* p = std::allocator<T>().allocate(n);
+    try {
+      tracker_->OnAllocate(p, n * sizeof(T), site_);
+    } catch (...) {
+      std::allocator<T>().deallocate(p, n);
+      throw;
+    }
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    tracker_->OnDeallocate(p);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <typename U>
+  void destroy(U* p) {
+    p->~U();
+    tracker_->OnDestroy(p);
+  }
+
+  RetentionTracker* tracker() const noexcept { return tracker_; }
+  const char* site() const noexcept { return site_; }
+
+ private:
+  RetentionTracker* tracker_;
+  const char* site_;
+};
+
+template <typename T, typename U>
+bool operator==(const RetentionAllocator<T>& lhs, const RetentionAllocator<U>& rhs) noexcept { return lhs.tracker() == rhs.tracker(); }
+template <typename T, typename U>
+bool operator!=(const RetentionAllocator<T>& lhs, const RetentionAllocator<U>& rhs) noexcept { return lhs.tracker() != rhs.tracker(); }
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_RETENTIONTRACKER_H_
@@ -0,0 +1,80 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_SHARDEDCOUNTER_H_
+#define UTILS_INCLUDE_SHARDEDCOUNTER_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace utils {
+
+/*
+Statistics counter for hot paths shared by many threads. A single std::atomic<std::size_t> makes
+every increment fight for one cache line; here each thread increments its own slot, every slot on
+its own cache line, and Load() sums the slots. Threads get slots round robin on their first
+increment, so up to Shards threads never share a slot.
+Increments are relaxed: Load() is exact once the incrementing threads have been joined, while they
+run it may miss increments that are in flight, like a relaxed load of a single atomic.
+Over-aligned types are not aligned by new before C++17, so create counters as statics or members
+of statics to be sure no two slots share a line.
+*/
+template <std::size_t Shards = 32>
+class ShardedCounter {
+  static_assert(Shards != 0 && (Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+ public:
+  static constexpr std::size_t kCacheLineSize = 64;
+
+  ShardedCounter() noexcept {
+    for (auto& slot : slots_) {
+      slot.value.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  ShardedCounter(const ShardedCounter&) = delete;
+  ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+  void Add(std::size_t n = 1) noexcept {
+    slots_[ThreadIndex() & (Shards - 1)].value.fetch_add(n, std::memory_order_relaxed);
+  }
+  ShardedCounter& operator++() noexcept {
+    Add(1);
+    return *this;
+  }
+
+  std::size_t Load() const noexcept {
+    std::size_t sum = 0;
+    for (auto& slot : slots_) {
+      sum += slot.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  // Not atomic with respect to concurrent increments
+  void Reset() noexcept {
+    for (auto& slot : slots_) {
+      slot.value.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct alignas(kCacheLineSize) Slot {
+    std::atomic<std::size_t> value;
+  };
+
+  // shared by all counters with the same Shards, so a thread uses the same slot index in each of them
+  static std::size_t ThreadIndex() noexcept {
+    static std::atomic<std::size_t> next_index{1};
+    thread_local std::size_t index = 0; // constant initialized, no guard on every call; 0 means not assigned yet
+    if (index == 0) {
+      index = next_index.fetch_add(1, std::memory_order_relaxed);
+    }
+    return index;
+  }
+
+  Slot slots_[Shards];
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_SHARDEDCOUNTER_H_
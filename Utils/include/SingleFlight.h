@@ -0,0 +1,145 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_SINGLEFLIGHT_H_
+#define UTILS_INCLUDE_SINGLEFLIGHT_H_
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/*
+Coalesces concurrent calls for the same key. The first Do(key, fn) runs fn; calls for that key
+arriving while it runs do not call their own fn, they wait for the running one and get its result.
+If fn throws, every waiter gets the same exception. Once the call has finished, the next Do for the
+key runs fn again: nothing is cached here.
+*/
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlight {
+ public:
+  template <typename Fn>
+  Value Do(const Key& key, Fn&& fn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = calls_.find(key);
+    if (it != calls_.end()) {
+      auto call = it->second;
+      ++shared_;
+      lock.unlock();
+      return call.get(); // rethrows the leader's exception
+    }
+
+    std::promise<Value> promise;
+    calls_.emplace(key, promise.get_future().share());
+    ++executed_;
+    lock.unlock();
+
+    try {
+      Value value = fn();
+      promise.set_value(value);
+      Finish(key);
+      return value;
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+      Finish(key);
+      throw;
+    }
+  }
+
+  /*
+  Do for count keys with one fn call. Keys in flight in another Do or DoMany are waited for; the
+  others are claimed, and fn(claimed, n) produces their values, in the order of claimed, in a
+  std::vector. Returns the values in keys order. fn runs before this call waits for anything, so two
+  batches waiting for each other's keys cannot deadlock. If fn throws, or returns another number of
+  values (std::length_error), the claimed keys' waiters and the caller get the exception.
+  */
+  template <typename BatchFn>
+  std::vector<Value> DoMany(const Key* keys, std::size_t count, BatchFn&& fn) {
+    std::vector<std::shared_future<Value>> futures(count);
+    std::vector<Key> claimed;
+    std::vector<std::promise<Value>> promises;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (std::size_t i = 0; i < count; ++i) {
+        auto it = calls_.find(keys[i]);
+        if (it != calls_.end()) {
+          futures[i] = it->second; // also a duplicate of a key claimed here, set below before waiting
+          ++shared_;
+          continue;
+        }
+        promises.emplace_back();
+        futures[i] = promises.back().get_future().share();
+        calls_.emplace(keys[i], futures[i]);
+        claimed.push_back(keys[i]);
+      }
+      executed_ += claimed.size();
+    }
+
+    if (!claimed.empty()) {
+      std::size_t fulfilled = 0;
+      try {
+        auto values = fn(claimed.data(), claimed.size());
+        if (values.size() != claimed.size()) {
+          throw std::length_error("SingleFlight::DoMany: fn returned a different number of values than keys");
+        }
+        for (; fulfilled < claimed.size(); ++fulfilled) {
+          promises[fulfilled].set_value(values[fulfilled]);
+        }
+      } catch (...) {
+        for (std::size_t k = fulfilled; k < claimed.size(); ++k) {
+          promises[k].set_exception(std::current_exception());
+        }
+        FinishMany(claimed);
+        throw;
+      }
+      FinishMany(claimed);
+    }
+
+    std::vector<Value> results;
+    results.reserve(count);
+    for (auto& future : futures) {
+      results.push_back(future.get()); // rethrows the leader's exception
+    }
+    return results;
+  }
+
+  // number of keys fn ran for
+  std::size_t Executed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return executed_;
+  }
+
+  // number of calls, or keys of a DoMany, that waited for another call's result instead of running fn
+  std::size_t Shared() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return shared_;
+  }
+
+ private:
+  void Finish(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    calls_.erase(key);
+  }
+
+  void FinishMany(const std::vector<Key>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& key : keys) {
+      calls_.erase(key);
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, std::shared_future<Value>, Hash> calls_;
+  std::size_t executed_ = 0;
+  std::size_t shared_ = 0;
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_SINGLEFLIGHT_H_
@@ -0,0 +1,152 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_SIZECLASSPOOL_H_
+#define UTILS_INCLUDE_SIZECLASSPOOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace utils {
+
+/*
+Size-class memory pool for many small, short lived objects.
+Requests up to kMaxPooledSize bytes are rounded up to a multiple of kGranularity and served from a
+per-thread free list of that size class, so Allocate and Deallocate take no lock in the common case.
+Free lists are refilled by carving kChunkSize chunks. Each block has a small header holding its size
+class, which lets Deallocate work without the size (e.g. from a deleter that only sees a base pointer).
+Larger requests go to ::operator new.
+
+A block may be released from any thread; it then joins that thread's free list. Chunks are never
+returned to the system, so blocks cached by a finished thread are not reused. They are not freed at
+exit either, since thread-local free lists and static objects destroyed after main may point into them.
+*/
+class SizeClassPool {
+ public:
+  static constexpr std::size_t kGranularity = 16;
+  static constexpr std::size_t kMaxPooledSize = 256;
+  static constexpr std::size_t kClassCount = kMaxPooledSize / kGranularity;
+  static constexpr std::size_t kChunkSize = 64 * 1024;
+
+  static void* Allocate(std::size_t size) {
+    if (size > kMaxPooledSize) {
+      auto header = static_cast<Header*>(::operator new(kHeaderSize + size));
+      header->size_class = kLargeClass;
+      return reinterpret_cast<char*>(header) + kHeaderSize;
+    }
+
+    const std::size_t size_class = size == 0 ? 0 : (size - 1) / kGranularity;
+    FreeNode*& free_list = Cache().free_lists[size_class];
+    if (free_list == nullptr) {
+      Refill(size_class, free_list);
+    }
+    FreeNode* node = free_list;
+    free_list = node->next;
+
+    auto header = reinterpret_cast<Header*>(node);
+    header->size_class = size_class;
+    return reinterpret_cast<char*>(header) + kHeaderSize;
+  }
+
+  static void Deallocate(void* p) noexcept {
+    if (p == nullptr) {
+      return;
+    }
+    auto header = reinterpret_cast<Header*>(static_cast<char*>(p) - kHeaderSize);
+    if (header->size_class == kLargeClass) {
+      ::operator delete(header);
+      return;
+    }
+
+    auto node = reinterpret_cast<FreeNode*>(header);
+    FreeNode*& free_list = Cache().free_lists[header->size_class];
+    node->next = free_list;
+    free_list = node;
+  }
+
+ private:
+  struct Header {
+    std::size_t size_class;
+  };
+  // keeps the returned memory aligned for any fundamental type
+  static constexpr std::size_t kHeaderSize = alignof(std::max_align_t) > sizeof(Header) ? alignof(std::max_align_t) : sizeof(Header);
+  static constexpr std::size_t kLargeClass = kClassCount;
+
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct ThreadCache {
+    FreeNode* free_lists[kClassCount];
+  };
+
+  // keeps every chunk reachable, so leak checkers do not report them
+  class ChunkRegistry {
+   public:
+    void* NewChunk() {
+      void* chunk = ::operator new(kChunkSize);
+      std::lock_guard<std::mutex> lock(mutex_);
+      try {
+        chunks_.push_back(chunk);
+      } catch (...) {
+        ::operator delete(chunk);
+        throw;
+      }
+      return chunk;
+    }
+   private:
+    std::mutex mutex_;
+    std::vector<void*> chunks_;
+  };
+
+  static ThreadCache& Cache() {
+    thread_local ThreadCache cache{};
+    return cache;
+  }
+
+  // never destroyed, the chunks are deliberately leaked at exit
+  static ChunkRegistry& Chunks() {
+    static ChunkRegistry* registry = new ChunkRegistry;
+    return *registry;
+  }
+
+  static void Refill(std::size_t size_class, FreeNode*& free_list) {
+    const std::size_t block_size = kHeaderSize + (size_class + 1) * kGranularity;
+    char* chunk = static_cast<char*>(Chunks().NewChunk());
+    for (std::size_t offset = 0; offset + block_size <= kChunkSize; offset += block_size) {
+      auto node = reinterpret_cast<FreeNode*>(chunk + offset);
+      node->next = free_list;
+      free_list = node;
+    }
+  }
+};
+
+// Standard allocator on top of SizeClassPool, e.g. for std::allocate_shared
+template <typename T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+
+  static_assert(alignof(T) <= alignof(std::max_align_t), "SizeClassPool does not support over-aligned types");
+
+  PoolAllocator() noexcept = default;
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(SizeClassPool::Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, std::size_t) noexcept {
+    SizeClassPool::Deallocate(p);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept { return true; }
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept { return false; }
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_SIZECLASSPOOL_H_
@@ -0,0 +1,87 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_THREADPOOL_H_
+#define UTILS_INCLUDE_THREADPOOL_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/*
+Fixed set of worker threads running submitted tasks in FIFO order. Tasks must not throw.
+The destructor runs the tasks still queued, then joins the workers.
+Default() is a process wide pool with one worker less than the hardware threads, for algorithms
+where the calling thread works too.
+*/
+class ThreadPool {
+ public:
+  explicit ThreadPool(std::size_t thread_count) {
+    workers_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+      workers_.emplace_back([this] { Run(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void Submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    wake_.notify_one();
+  }
+
+  std::size_t Size() const noexcept { return workers_.size(); }
+
+  static ThreadPool& Default() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return; // stopping and nothing left
+      }
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_; // last, so it starts after everything above is initialized
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_THREADPOOL_H_
@@ -0,0 +1,222 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_TRACKED_H_
+#define UTILS_INCLUDE_TRACKED_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+// Special member calls counted by Tracked. Subtract two snapshots to get the calls made in between
+struct SpecialMemberCounts {
+  std::size_t default_constructed = 0;
+  std::size_t value_constructed = 0; // through the forwarding constructor
+  std::size_t copy_constructed = 0;
+  std::size_t move_constructed = 0;
+  std::size_t copy_assigned = 0;
+  std::size_t move_assigned = 0;
+  std::size_t destroyed = 0;
+
+  std::size_t Copies() const noexcept { return copy_constructed + copy_assigned; }
+  std::size_t Moves() const noexcept { return move_constructed + move_assigned; }
+  std::size_t Alive() const noexcept {
+    return default_constructed + value_constructed + copy_constructed + move_constructed - destroyed;
+  }
+};
+
+inline SpecialMemberCounts operator-(const SpecialMemberCounts& lhs, const SpecialMemberCounts& rhs) noexcept {
+  SpecialMemberCounts result;
+  result.default_constructed = lhs.default_constructed - rhs.default_constructed;
+  result.value_constructed = lhs.value_constructed - rhs.value_constructed;
+  result.copy_constructed = lhs.copy_constructed - rhs.copy_constructed;
+  result.move_constructed = lhs.move_constructed - rhs.move_constructed;
+  result.copy_assigned = lhs.copy_assigned - rhs.copy_assigned;
+  result.move_assigned = lhs.move_assigned - rhs.move_assigned;
+  result.destroyed = lhs.destroyed - rhs.destroyed;
+  return result;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const SpecialMemberCounts& counts) {
+  return os << counts.default_constructed << " default, " << counts.value_constructed << " value, "
+            << counts.copy_constructed << " copy constructed, " << counts.move_constructed << " move constructed, "
+            << counts.copy_assigned << " copy assigned, " << counts.move_assigned << " move assigned, "
+            << counts.destroyed << " destroyed";
+}
+
+/*
+Wraps a T and counts its special member calls, e.g. to check that a code path makes no copies:
+    auto before = Tracked<std::string>::Counts();
+    v.push_back(Tracked<std::string>("Scott"));
+    assert((Tracked<std::string>::Counts() - before).Copies() == 0);
+Counters are per Tracked<T, Tag> type; use a Tag to count the same T separately in different places.
+Each thread counts in its own block of relaxed atomics that only it writes, so a count is a plain
+load, add and store without a locked instruction, and Counts() sums the blocks and a shared total.
+When a thread exits its counts are added to the total and its block is left for the next thread, so
+the blocks follow the most threads counting at once, not every thread ever started. A thread that
+cannot get a block counts on the shared total with atomic increments.
+noexcept of the move operations follows T, so containers pick move or copy the same way as for T.
+*/
+template <typename T, typename Tag = void>
+class Tracked {
+  template <typename... Args>
+  struct IsSelf : std::false_type {};
+  template <typename Arg>
+  struct IsSelf<Arg> : std::is_same<std::decay_t<Arg>, Tracked> {};
+
+ public:
+  Tracked() : value_() { Count(kDefault); }
+
+  template <typename... Args, typename = std::enable_if_t<sizeof...(Args) != 0 && !IsSelf<Args...>::value>>
+  explicit Tracked(Args&&... args) : value_(std::forward<Args>(args)...) {
+    Count(kValue);
+  }
+
+  Tracked(const Tracked& rhs) : value_(rhs.value_) { Count(kCopyConstruct); }
+  Tracked(Tracked&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) : value_(std::move(rhs.value_)) {
+    Count(kMoveConstruct);
+  }
+
+  Tracked& operator=(const Tracked& rhs) {
+    value_ = rhs.value_;
+    Count(kCopyAssign);
+    return *this;
+  }
+  Tracked& operator=(Tracked&& rhs) noexcept(std::is_nothrow_move_assignable<T>::value) {
+    value_ = std::move(rhs.value_);
+    Count(kMoveAssign);
+    return *this;
+  }
+
+  ~Tracked() { Count(kDestroy); }
+
+  T& get() noexcept { return value_; }
+  const T& get() const noexcept { return value_; }
+  T& operator*() noexcept { return value_; }
+  const T& operator*() const noexcept { return value_; }
+  T* operator->() noexcept { return &value_; }
+  const T* operator->() const noexcept { return &value_; }
+
+  static SpecialMemberCounts Counts() noexcept {
+    SpecialMemberCounts counts;
+    counts.default_constructed = Load(kDefault);
+    counts.value_constructed = Load(kValue);
+    counts.copy_constructed = Load(kCopyConstruct);
+    counts.move_constructed = Load(kMoveConstruct);
+    counts.copy_assigned = Load(kCopyAssign);
+    counts.move_assigned = Load(kMoveAssign);
+    counts.destroyed = Load(kDestroy);
+    return counts;
+  }
+
+  // Not atomic with respect to threads counting concurrently
+  static void ResetCounts() noexcept {
+    for (ThreadCounts* block = head_.load(std::memory_order_acquire); block; block = block->next) {
+      for (auto& counter : block->counters) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+    }
+    for (auto& counter : retired_) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  static void Report(std::ostream& os, const char* name) { os << name << ": " << Counts() << '\n'; }
+
+ private:
+  enum Kind { kDefault, kValue, kCopyConstruct, kMoveConstruct, kCopyAssign, kMoveAssign, kDestroy, kKinds };
+
+  struct ThreadCounts {
+    std::atomic<std::size_t> counters[kKinds];
+    std::atomic<bool> in_use;
+    ThreadCounts* next;
+  };
+
+  // The calling thread's block, handed back when the thread exits
+  struct LocalCounts {
+    ~LocalCounts() {
+      exited = true;
+      if (block != nullptr) {
+        Release(block);
+      }
+    }
+
+    ThreadCounts* block = nullptr;
+    bool exited = false; // counts from later thread_local destructors go to retired_
+  };
+
+  static void Count(Kind kind) noexcept {
+    thread_local LocalCounts local;
+    if (local.block == nullptr && !local.exited) {
+      local.block = Acquire();
+    }
+    if (local.block == nullptr) {
+      retired_[kind].fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::atomic<std::size_t>& counter = local.block->counters[kind];
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // only this thread writes it
+  }
+
+  static std::size_t Load(Kind kind) noexcept {
+    std::size_t sum = retired_[kind].load(std::memory_order_relaxed);
+    for (ThreadCounts* block = head_.load(std::memory_order_acquire); block; block = block->next) {
+      sum += block->counters[kind].load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  // A block left by an exited thread, or a new one; nullptr if none can be allocated
+  static ThreadCounts* Acquire() noexcept {
+    for (ThreadCounts* block = head_.load(std::memory_order_acquire); block; block = block->next) {
+      bool in_use = false;
+      if (!block->in_use.load(std::memory_order_relaxed) &&
+          block->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+        return block;
+      }
+    }
+
+    // never freed, head_ keeps it reachable for Counts() and for reuse
+    ThreadCounts* block = new (std::nothrow) ThreadCounts;
+    if (block == nullptr) {
+      return nullptr;
+    }
+    for (auto& counter : block->counters) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    block->in_use.store(true, std::memory_order_relaxed);
+    block->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return block;
+  }
+
+  // Moves the counts to retired_ and frees the block for another thread
+  static void Release(ThreadCounts* block) noexcept {
+    for (int kind = 0; kind < kKinds; ++kind) {
+      const std::size_t count = block->counters[kind].load(std::memory_order_relaxed);
+      retired_[kind].fetch_add(count, std::memory_order_relaxed);
+      block->counters[kind].store(0, std::memory_order_relaxed);
+    }
+    block->in_use.store(false, std::memory_order_release);
+  }
+
+  static std::atomic<ThreadCounts*> head_; // blocks of all threads counting now or before
+  static std::atomic<std::size_t> retired_[kKinds]; // counts of exited threads
+
+  T value_;
+};
+
+template <typename T, typename Tag>
+std::atomic<typename Tracked<T, Tag>::ThreadCounts*> Tracked<T, Tag>::head_{nullptr};
+
+template <typename T, typename Tag>
+std::atomic<std::size_t> Tracked<T, Tag>::retired_[Tracked<T, Tag>::kKinds];
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_TRACKED_H_
@@ -0,0 +1,298 @@
+#pragma once //For compatibility
+
+#ifndef UTILS_INCLUDE_WEAKCACHE_H_
+#define UTILS_INCLUDE_WEAKCACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/*
+Thread-safe cache of std::weak_ptrs: it hands out objects that somebody still owns, but does not
+keep them alive itself.
+Keys are spread over lock-striped shards, so threads working on different keys rarely wait for
+each other. Expired entries are overwritten when their key is inserted again, and each shard
+sweeps all its expired entries once it has grown to twice its live size at the previous sweep, so
+the sweeping cost is amortised over the inserts and memory stays proportional to the live objects.
+
+Optionally a bounded strong tier keeps the strong_capacity most recently used objects alive even
+when no caller holds them, so hot keys survive the gaps between bursts. Each shard keeps an LRU list
+of its share of strong_capacity, the shares adding up to exactly strong_capacity, so at most that
+many objects are pinned; lookups that miss the list fall through to the weak entries.
+*/
+template <typename Key, typename T, typename Hash = std::hash<Key>>
+class WeakCache {
+ public:
+  struct Stats {
+    std::size_t hits = 0;
+    std::size_t strong_hits = 0; // hits served by the strong tier, included in hits
+    std::size_t misses = 0;
+    std::size_t entries = 0; // live entries plus expired ones not swept yet
+    std::size_t pinned = 0; // objects kept alive by the strong tier
+  };
+
+  // shard_count is rounded up to a power of two; strong_capacity 0 disables the strong tier
+  explicit WeakCache(std::size_t shard_count = 16, std::size_t strong_capacity = 0)
+      : shards_(RoundUpToPowerOfTwo(shard_count)) {
+    // the first strong_capacity % shards shards take one extra slot
+    for (std::size_t s = 0; s < shards_.size(); ++s) {
+      shards_[s].strong_capacity = strong_capacity / shards_.size() + (s < strong_capacity % shards_.size() ? 1 : 0);
+    }
+  }
+
+  WeakCache(const WeakCache&) = delete;
+  WeakCache& operator=(const WeakCache&) = delete;
+
+  // empty pointer if key is not cached or its object is gone
+  std::shared_ptr<T> Find(const Key& key) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return FindLocked(shard, key);
+  }
+
+  // Caches value unless a live object is already cached for key; returns the cached object
+  std::shared_ptr<T> Insert(const Key& key, std::shared_ptr<T> value) {
+    Shard& shard = ShardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return InsertLocked(shard, key, std::move(value));
+  }
+
+  // Find, and on a miss create the object with loader(key) outside the lock and Insert it
+  template <typename Loader>
+  std::shared_ptr<T> GetOrLoad(const Key& key, Loader&& loader) {
+    if (auto cached = Find(key)) {
+      return cached;
+    }
+    return Insert(key, loader(key));
+  }
+
+  /*
+  Batch GetOrLoad for count keys, results come back in key order. Duplicate keys are looked up and
+  loaded once, and count once in the stats. Keys are grouped by shard so each shard is locked once per
+  pass: one pass finds the hits, the missing keys go to a single loader(keys, n) call, which returns
+  their objects in the same order (std::length_error if it returns another number), and a second pass
+  inserts them. Concurrent calls missing the same key may both load it and Insert keeps the first live
+  one; to load each key once, have loader go through SingleFlight::DoMany, like GetOrLoad through Do.
+  */
+  template <typename BatchLoader>
+  std::vector<std::shared_ptr<T>> GetOrLoadMany(const Key* keys, std::size_t count, BatchLoader&& loader) {
+    std::vector<Key> distinct;
+    std::vector<std::size_t> distinct_index(count); // position of keys[i] in distinct
+    {
+      std::unordered_map<Key, std::size_t, Hash> positions(count);
+      for (std::size_t i = 0; i < count; ++i) {
+        auto inserted = positions.emplace(keys[i], distinct.size());
+        if (inserted.second) {
+          distinct.push_back(keys[i]);
+        }
+        distinct_index[i] = inserted.first->second;
+      }
+    }
+
+    std::vector<std::shared_ptr<T>> values(distinct.size());
+    ForEachByShard(distinct.data(), distinct.size(), [&](Shard& shard, std::size_t d) {
+      values[d] = FindLocked(shard, distinct[d]);
+    });
+
+    std::vector<Key> to_load;
+    std::vector<std::size_t> load_index; // position of to_load[i] in distinct
+    for (std::size_t d = 0; d < distinct.size(); ++d) {
+      if (!values[d]) {
+        to_load.push_back(distinct[d]);
+        load_index.push_back(d);
+      }
+    }
+    if (!to_load.empty()) {
+      auto loaded = loader(to_load.data(), to_load.size());
+      if (loaded.size() != to_load.size()) {
+        throw std::length_error("WeakCache::GetOrLoadMany: loader returned a different number of values than keys");
+      }
+      ForEachByShard(to_load.data(), to_load.size(), [&](Shard& shard, std::size_t i) {
+        values[load_index[i]] = InsertLocked(shard, to_load[i], std::move(loaded[i]));
+      });
+    }
+
+    std::vector<std::shared_ptr<T>> results(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      results[i] = values[distinct_index[i]];
+    }
+    return results;
+  }
+
+  std::size_t Size() const {
+    std::size_t size = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  Stats GetStats() const {
+    Stats stats;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      stats.hits += shard.hits;
+      stats.strong_hits += shard.strong_hits;
+      stats.misses += shard.misses;
+      stats.entries += shard.map.size();
+      stats.pinned += shard.lru.size();
+    }
+    return stats;
+  }
+
+ private:
+  static constexpr std::size_t kMinSweepSize = 64;
+
+  using LruList = std::list<std::pair<Key, std::shared_ptr<T>>>; // most recently used first
+
+  struct Entry {
+    std::weak_ptr<T> weak;
+    typename LruList::iterator lru_position;
+    bool pinned = false; // lru_position is valid
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<Key, Entry, Hash> map;
+    LruList lru;
+    std::size_t sweep_size = kMinSweepSize; // sweep when map reaches this size
+    std::size_t strong_capacity = 0; // this shard's share of the strong tier
+    std::size_t hits = 0;
+    std::size_t strong_hits = 0;
+    std::size_t misses = 0;
+    char padding[64]; // keeps neighbouring shards' mutexes off the same cache line
+  };
+
+  std::size_t ShardIndex(const Key& key) const {
+    // multiplicative mixing, std::hash is the identity for integers on common implementations
+    const std::uint64_t h = static_cast<std::uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+    return (h >> 32) & (shards_.size() - 1);
+  }
+
+  Shard& ShardFor(const Key& key) { return shards_[ShardIndex(key)]; }
+
+  // calls fn(shard, i) for every key index with the key's shard locked, taking each lock once
+  template <typename Fn>
+  void ForEachByShard(const Key* keys, std::size_t count, Fn&& fn) {
+    // counting sort of the key indices by shard
+    std::vector<std::size_t> shard_of(count);
+    std::vector<std::size_t> begin(shards_.size() + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+      shard_of[i] = ShardIndex(keys[i]);
+      ++begin[shard_of[i] + 1];
+    }
+    for (std::size_t s = 0; s < shards_.size(); ++s) {
+      begin[s + 1] += begin[s];
+    }
+    std::vector<std::size_t> order(count);
+    std::vector<std::size_t> next(begin.begin(), begin.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+      order[next[shard_of[i]]++] = i;
+    }
+
+    for (std::size_t s = 0; s < shards_.size(); ++s) {
+      if (begin[s] == begin[s + 1]) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(shards_[s].mutex);
+      for (std::size_t k = begin[s]; k < begin[s + 1]; ++k) {
+        fn(shards_[s], order[k]);
+      }
+    }
+  }
+
+  static std::size_t RoundUpToPowerOfTwo(std::size_t n) {
+    std::size_t result = 1;
+    while (result < n) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  std::shared_ptr<T> FindLocked(Shard& shard, const Key& key) {
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
+      ++shard.misses;
+      return nullptr;
+    }
+    Entry& entry = it->second;
+    if (entry.pinned) {
+      ++shard.hits;
+      ++shard.strong_hits;
+      shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru_position);
+      return entry.lru_position->second;
+    }
+    auto value = entry.weak.lock();
+    if (value) {
+      ++shard.hits;
+      Pin(shard, key, entry, value);
+    } else {
+      ++shard.misses; // the expired entry is kept, a following Insert reuses it
+    }
+    return value;
+  }
+
+  // moves key to the front of the strong tier, evicting the least recently used one if it is full
+  void Pin(Shard& shard, const Key& key, Entry& entry, const std::shared_ptr<T>& value) {
+    if (shard.strong_capacity == 0) {
+      return;
+    }
+    if (entry.pinned) {
+      shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru_position);
+      return;
+    }
+    if (shard.lru.size() == shard.strong_capacity) {
+      auto& evicted = shard.lru.back();
+      shard.map.find(evicted.first)->second.pinned = false; // pinned keys are never swept, its weak entry stays
+      shard.lru.pop_back();
+    }
+    shard.lru.emplace_front(key, value);
+    entry.lru_position = shard.lru.begin();
+    entry.pinned = true;
+  }
+
+  std::shared_ptr<T> InsertLocked(Shard& shard, const Key& key, std::shared_ptr<T> value) {
+    Entry& entry = shard.map[key];
+    if (auto existing = entry.weak.lock()) {
+      Pin(shard, key, entry, existing);
+      return existing; // another thread was faster
+    }
+    entry.weak = value;
+    Pin(shard, key, entry, value);
+    if (shard.map.size() >= shard.sweep_size) {
+      Sweep(shard);
+    }
+    return value;
+  }
+
+  static void Sweep(Shard& shard) {
+    for (auto it = shard.map.begin(); it != shard.map.end();) {
+      if (it->second.weak.expired()) { // pinned entries are never expired
+        it = shard.map.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    shard.sweep_size = 2 * shard.map.size();
+    if (shard.sweep_size < kMinSweepSize) {
+      shard.sweep_size = kMinSweepSize;
+    }
+  }
+
+  std::vector<Shard> shards_;
+};
+
+} // namespace utils
+
+#endif //UTILS_INCLUDE_WEAKCACHE_H_